@@ -0,0 +1,82 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file batchmain.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of batchmain.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <GeomScene.h>
+#include <GeomSceneIO.h>
+#include <GeomBatch.h>
+
+namespace sm = simugeom;
+
+int main(int argc, char** argv)
+{
+    if(argc<7)
+    {
+        std::cerr<<"usage: "<<argv[0]<<" template.gscn count seed_begin out_prefix length breadth"
+                 <<" [maxiters] [num_proposals] [num_threads] [stall_window]"<<std::endl;
+        return 1;
+    }
+
+    sm::GeomScene scn;
+    sm::GeomSceneReader gsr(scn);
+    if(gsr.read(argv[1])!=0)
+    {
+        std::cerr<<"cannot read "<<argv[1]<<std::endl;
+        return 1;
+    }
+    {
+        // the scene files do not keep the boundary
+        Eigen::Vector3d pos, rad;
+        pos(0, 0) = 0.0;
+        pos(1, 0) = 0.0;
+        pos(2, 0) = 0.0;
+        rad(0, 0) = 0.5*std::atof(argv[5]);
+        rad(1, 0) = 0.5*std::atof(argv[6]);
+        rad(2, 0) = 1.0;
+        scn.set_boundary(sm::AABB(pos, rad));
+    }
+
+    sm::GeomBatch gbt(scn);
+    gbt.set_maxiters((argc>7)?std::atoi(argv[7]):500);
+    gbt.set_num_proposals((argc>8)?std::atoi(argv[8]):1);
+    gbt.set_num_threads((argc>9)?std::atoi(argv[9]):0);
+    {
+        // stop a scene once its best has not improved for this many iterations
+        sm::GeomStopCriteria stop;
+        stop.stall_window = (argc>10)?std::atoi(argv[10]):0;
+        gbt.set_stop_criteria(stop);
+    }
+
+    sm::GeomBatchWriterSink sink(argv[4]);
+    const int status = gbt.run(std::atoll(argv[2]), std::strtoul(argv[3], nullptr, 10), sink);
+    gbt.export_timing((std::string(argv[4])+"timing.txt").c_str());
+
+    std::cout<<gbt.get_jobs().size()<<" scenes in "<<gbt.get_seconds()<<" s, "
+             <<gbt.get_scenes_per_hour()<<" scenes/hour"<<std::endl;
+    return (status==0)?0:1;
+}
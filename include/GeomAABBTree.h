@@ -0,0 +1,101 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomAABBTree.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomAABBTree.
+ */
+
+#ifndef GEOMAABBTREE_H
+#define GEOMAABBTREE_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "GeomSceneSoA.h"
+
+namespace simugeom
+{
+
+class GeomAABBTree
+{
+public:
+    GeomAABBTree();
+    virtual ~GeomAABBTree();
+
+    void build(const GeomSceneSoA& soa);
+    void update(const GeomSceneSoA& soa, const int oid);
+    void query(const int oid, std::vector<int>& oids) const;
+    void query(const GeomSceneSoA& soa, const int oid, std::vector<int>& oids) const;
+    void query_pairs(std::vector<std::pair<int, int>>& pairs) const;
+
+    int32_t get_height() const
+    {
+        return (root<0)?0:nodes[root].height;
+    }
+
+private:
+    struct Box
+    {
+        double x0, y0, x1, y1;
+    };
+
+    struct Node
+    {
+        Box box;
+        int32_t parent, child0, child1, height, oid;
+        bool is_leaf() const
+        {
+            return child0<0;
+        }
+    };
+
+    struct Leaf
+    {
+        int32_t node;
+        bool is_fixed;
+        Box tight;
+    };
+
+    static Box get_union(const Box& a, const Box& b);
+    static double get_perimeter(const Box& b);
+    static bool is_overlapping(const Box& a, const Box& b);
+    static bool is_containing(const Box& a, const Box& b);
+    static Box get_tight_box(const GeomSceneSoA& soa, const int oid);
+
+    int32_t alloc_node();
+    void free_node(const int32_t n);
+    void insert_leaf(const int32_t leaf);
+    void remove_leaf(const int32_t leaf);
+    void refit(int32_t n);
+    int32_t balance(const int32_t a);
+    void query_box(const Box& box, const int oid, std::vector<int>& oids) const;
+
+    int32_t root;
+    int32_t free_list;
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+};
+
+}
+
+#endif // GEOMAABBTREE_H
@@ -30,27 +30,100 @@
 
 #include "GeomScene.h"
 #include "GeomRenderer.h"
+#include "GeomTrace.h"
+#include "GeomCheckpoint.h"
+#include "GeomSchedule.h"
+#include <atomic>
+#include <limits>
+#include <chrono>
 
 namespace simugeom
 {
 
+// when solve() may end before maxiters, every criterion is off by default
+struct GeomStopCriteria
+{
+    // iterations in a row without a new best
+    int32_t stall_window;
+    // the best has to improve by converge_ratio of itself within
+    // converge_window iterations
+    int32_t converge_window;
+    double converge_ratio;
+    // a best at or below this is good enough
+    double target_cost;
+    // wall clock time of one solve() or resume()
+    double max_seconds;
+
+    GeomStopCriteria() : stall_window(0), converge_window(0), converge_ratio(0.0),
+        target_cost(-std::numeric_limits<double>::max()), max_seconds(0.0)
+    {
+    }
+};
+
 class GeomAnnealer
 {
     public:
+        enum class ProposalMode {Sequential, MultipleTry};
+        enum class StopReason {MaxIters, Stalled, Converged, TargetCost, Deadline, Aborted};
+
         GeomAnnealer(GeomScene& _gsn);
         virtual ~GeomAnnealer();
 
         void set_num_proposals(const int32_t n) { num_proposals = n; }
+        void set_proposal_mode(const ProposalMode mode) { proposal_mode = mode; }
+        ProposalMode get_proposal_mode() const { return proposal_mode; }
         void set_renderer(GeomRenderer& _grdr);
         void initialise();
-        void iterate(const double beta = 1.0);
+        void iterate();
         void set_maxiters(const int32_t _maxiters = 500);
-        void solve();
-        void export_cost_graph(const char* fname);
+        // temperature and step scale of every iteration, nullptr is the
+        // classic fixed schedule
+        void set_schedule(GeomSchedule* _schedule);
+        void set_stop_criteria(const GeomStopCriteria& _stop) { stop = _stop; }
+        const GeomStopCriteria& get_stop_criteria() const { return stop; }
+        // runs the schedule until maxiters or a stopping criterion, and
+        // tells which one ended it
+        StopReason solve();
+        // the cost trace is streamed to the sink, nothing is kept otherwise
+        void set_trace_sink(GeomTraceSink* _trace);
+        // every interval iterations the full state is written to fname in
+        // the background, 0 turns it off
+        int set_checkpoint(const char* fname, const int32_t interval);
+        int save_checkpoint(const char* fname) const;
+        // restores a checkpoint of this scene and finishes its run, which
+        // ends exactly as the uninterrupted one would
+        int resume(const char* fname);
+        void set_shared_best(std::atomic<double>* _shared_best, const double _abort_margin = 0.25);
+
+        double get_cost_best() const
+        {
+            return cost_best;
+        }
+
+        bool get_is_aborted() const
+        {
+            return (stop_reason==StopReason::Aborted);
+        }
+
+        StopReason get_stop_reason() const
+        {
+            return stop_reason;
+        }
+
+        int32_t get_curr_iter() const
+        {
+            return curr_iter;
+        }
 
     protected:
         void download_best_solution();
         void upload_best_solution();
+        void iterate_multiple_try(const int oid);
+        bool publish_best();
+        bool get_is_stopping(const double best_before, const std::chrono::steady_clock::time_point t0);
+        void run();
+        void serialize_state(std::vector<char>& buf) const;
+        int deserialize_state(const char* data, const std::size_t size);
 
     private:
         GeomScene& gsn;
@@ -60,10 +133,27 @@ class GeomAnnealer
         int32_t curr_iter;
         int32_t maxiters;
         int32_t num_proposals;
+        ProposalMode proposal_mode;
+        std::vector<GeomPose> ref_poses;
+        std::vector<double> costs_prop, costs_ref;
         std::vector<GeomPose> pose_best;
-        std::vector<double> cost_bests, cost_news;
+        GeomScheduleClassic schedule_classic;
+        GeomSchedule* schedule;
+        GeomScheduleStats stats;
         bool has_renderer;
         GeomRenderer* grdr;
+        GeomTraceSink* trace;
+        GeomCheckpointWriter ckpt;
+        int32_t ckpt_interval;
+        std::vector<char> ckpt_buf;
+        std::atomic<double>* shared_best;
+        double abort_margin;
+        GeomStopCriteria stop;
+        StopReason stop_reason;
+        // last iteration with a new best, and the best after each of the
+        // last converge_window iterations
+        int32_t iter_improved;
+        std::vector<double> best_ring;
 };
 
 }
@@ -0,0 +1,86 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomAnnealerEnsemble.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomAnnealerEnsemble.
+ */
+
+#ifndef GEOMANNEALERENSEMBLE_H
+#define GEOMANNEALERENSEMBLE_H
+
+#include "GeomAnnealer.h"
+
+namespace simugeom
+{
+
+// independent annealing runs on clones of one scene, the best cost so far
+// is shared so that the runs far behind it can stop early
+class GeomAnnealerEnsemble
+{
+    public:
+        GeomAnnealerEnsemble(GeomScene& _gsn, const int32_t _num_runs = 4);
+        virtual ~GeomAnnealerEnsemble();
+
+        void set_num_runs(const int32_t n) { num_runs = n; }
+        void set_num_proposals(const int32_t n) { num_proposals = n; }
+        void set_maxiters(const int32_t _maxiters = 500) { maxiters = _maxiters; }
+        void set_abort_margin(const double margin) { abort_margin = margin; }
+        void set_proposal_mode(const GeomAnnealer::ProposalMode mode) { proposal_mode = mode; }
+        // every run anneals with its own clone of the schedule, the classic
+        // one if null
+        void set_schedule(const GeomSchedule* _schedule) { schedule = _schedule; }
+        void set_stop_criteria(const GeomStopCriteria& _stop) { stop = _stop; }
+        void solve();
+
+        double get_cost_best() const
+        {
+            return cost_best;
+        }
+
+        int32_t get_best_run() const
+        {
+            return best_run;
+        }
+
+        int32_t get_num_aborted() const
+        {
+            return num_aborted;
+        }
+
+    private:
+        GeomScene& gsn;
+        int32_t num_runs;
+        int32_t num_proposals;
+        int32_t maxiters;
+        double abort_margin;
+        GeomAnnealer::ProposalMode proposal_mode;
+        const GeomSchedule* schedule;
+        GeomStopCriteria stop;
+        double cost_best;
+        int32_t best_run;
+        int32_t num_aborted;
+};
+
+}
+
+#endif // GEOMANNEALERENSEMBLE_H
@@ -0,0 +1,115 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomBatch.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomBatch.
+ */
+
+#ifndef GEOMBATCH_H
+#define GEOMBATCH_H
+
+#include "GeomScene.h"
+#include "GeomAnnealer.h"
+#include <string>
+
+namespace simugeom
+{
+
+// record of one generated scene
+struct GeomBatchJob
+{
+    int64_t index;
+    uint32_t seed;
+    double cost;
+    double seconds;
+    int32_t worker;
+    int status;
+    int32_t num_iters;
+    GeomAnnealer::StopReason stop_reason;
+};
+
+// receives every solved scene, called concurrently from the workers
+class GeomBatchSink
+{
+    public:
+        virtual ~GeomBatchSink() {}
+        virtual int consume(const GeomScene& gs, const GeomBatchJob& job) = 0;
+};
+
+// writes each scene to <prefix><index>.gscn
+class GeomBatchWriterSink : public GeomBatchSink
+{
+    public:
+        GeomBatchWriterSink(const std::string& _prefix) : prefix(_prefix) {}
+        int consume(const GeomScene& gs, const GeomBatchJob& job) override;
+
+    private:
+        std::string prefix;
+};
+
+// solves copies of a template scene for a range of seeds on all cores,
+// idle workers steal jobs from the others
+class GeomBatch
+{
+    public:
+        GeomBatch(const GeomScene& _templ);
+        virtual ~GeomBatch();
+
+        void set_num_threads(const int32_t n) { num_threads = n; }
+        void set_num_proposals(const int32_t n) { num_proposals = n; }
+        void set_maxiters(const int32_t _maxiters = 500) { maxiters = _maxiters; }
+        void set_stop_criteria(const GeomStopCriteria& _stop) { stop = _stop; }
+        int run(const int64_t count, const uint32_t seed_begin, GeomBatchSink& sink);
+        int export_timing(const char* fname) const;
+
+        const std::vector<GeomBatchJob>& get_jobs() const
+        {
+            return jobs;
+        }
+
+        double get_seconds() const
+        {
+            return seconds;
+        }
+
+        double get_scenes_per_hour() const
+        {
+            return (seconds>0.0)?(3600.0*jobs.size()/seconds):0.0;
+        }
+
+    protected:
+        void solve_job(GeomBatchJob& job, const int32_t worker, GeomBatchSink& sink);
+
+    private:
+        const GeomScene& templ;
+        int32_t num_threads;
+        int32_t num_proposals;
+        int32_t maxiters;
+        GeomStopCriteria stop;
+        double seconds;
+        std::vector<GeomBatchJob> jobs;
+};
+
+}
+
+#endif // GEOMBATCH_H
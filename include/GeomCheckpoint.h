@@ -0,0 +1,89 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomCheckpoint.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomCheckpoint.
+ */
+
+#ifndef GEOMCHECKPOINT_H
+#define GEOMCHECKPOINT_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace simugeom
+{
+
+// writes checkpoint buffers to a file on its own thread, each one to a
+// temporary file first that then replaces the previous checkpoint, so the
+// file always holds a complete one; a buffer posted while the previous one
+// is still being written replaces any other that waits
+class GeomCheckpointWriter
+{
+    public:
+        GeomCheckpointWriter();
+        virtual ~GeomCheckpointWriter();
+
+        int open(const char* fname);
+        // takes the content of buf and leaves it with an older buffer
+        void post(std::vector<char>& buf);
+        // waits until everything posted is on disk
+        int flush();
+        int close();
+
+        bool get_is_open() const
+        {
+            return is_open;
+        }
+
+        int64_t get_num_written() const
+        {
+            return num_written;
+        }
+
+        static int write_file(const char* fname, const std::vector<char>& buf);
+
+    protected:
+        void run();
+
+    private:
+        std::string fname;
+        std::vector<char> pending, current;
+        bool is_open;
+        bool has_pending;
+        bool is_busy;
+        bool is_stopping;
+        int status;
+        int64_t num_written;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::thread worker;
+};
+
+}
+
+#endif // GEOMCHECKPOINT_H
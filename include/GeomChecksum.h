@@ -0,0 +1,42 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomChecksum.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomChecksum.
+ */
+
+#ifndef GEOMCHECKSUM_H
+#define GEOMCHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace simugeom
+{
+
+// crc-32 (ieee), pass a previous result as crc to continue it
+uint32_t get_crc32(const void* data, const std::size_t n, const uint32_t crc = 0);
+
+}
+
+#endif // GEOMCHECKSUM_H
@@ -0,0 +1,124 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomKernels.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomKernels.
+ */
+
+#ifndef GEOMKERNELS_H
+#define GEOMKERNELS_H
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "ObjClass.h"
+
+namespace simugeom
+{
+
+/*
+ * bb radius of a model at (px, py) with rotation cosine/sine (cr, sr)
+ * towards the point (x, y). The direction is rotated into the model
+ * frame as (u, v) = rho*(cos(reltheta), sin(reltheta)), which replaces
+ * the atan2, cos and sin of the angular form by exact algebra:
+ *   cuboid:    rho*min(rx/|u|, ry/|v|)
+ *   ellipsoid: sqrt((rx*u)^2+(ry*v)^2)/rho
+ * A point at the centre takes reltheta = -rot like atan2(0, 0) does.
+ * The relative error is a few ulp times the aspect ratio max(rx, ry)/
+ * min(rx, ry) (cancellation in u or v), e.g. below 2e-14 at 1:50.
+ */
+inline double get_bb_radius_kernel(const ObjClass::GeomType type, const double rx, const double ry,
+                                   const double px, const double py, const double cr, const double sr,
+                                   const double x, const double y)
+{
+    const double dx = x-px;
+    const double dy = y-py;
+    const double rho2 = dx*dx+dy*dy;
+    double u = cr*dx+sr*dy;
+    double v = cr*dy-sr*dx;
+    double rho = std::sqrt(rho2);
+    if(rho2==0.0)
+    {
+        u = cr;
+        v = -sr;
+        rho = 1.0;
+    }
+    if(type==ObjClass::GeomType::Cuboid)
+    {
+        return rho*std::min(rx/std::abs(u), ry/std::abs(v));
+    }
+    const double tu = rx*u;
+    const double tv = ry*v;
+    return std::sqrt(tu*tu+tv*tv)/rho;
+}
+
+/*
+ * batched form of get_bb_radius_kernel for one model and n query points.
+ * AVX-512 or AVX2 is picked at runtime when the cpu has it, otherwise a
+ * scalar loop is used; all paths perform the same operations in the same
+ * order, so they only differ where a compiler contracts them into fma.
+ */
+void get_bb_radius_batch(const ObjClass::GeomType type, const double rx, const double ry,
+                         const double px, const double py, const double cr, const double sr,
+                         const double* x, const double* y, double* out, const int32_t n);
+
+const char* get_kernel_isa();
+
+static constexpr int32_t bb_profile_size = 256;
+
+/*
+ * radius profile of a model, sampled at bb_profile_size+1 directions of
+ * the first quadrant of the model frame, uniform in the diamond angle of
+ * the direction (a monotone stand-in for the angle which needs no
+ * atan2). Both shapes are symmetric about their axes, so the other
+ * quadrants are folded onto it.
+ */
+void get_bb_radius_profile(const ObjClass::GeomType type, const double rx, const double ry, double* prof);
+
+/*
+ * bb radius interpolated linearly from a profile. Samples are exact bb
+ * radii, so the result never exceeds get_bb_radius_max. With 256
+ * samples per quadrant the relative error is below 1e-4 for ellipsoids up to 1:5 and
+ * about 1% for cuboids, whose corners fall between samples.
+ */
+inline double get_bb_radius_lookup(const double* prof, const double px, const double py,
+                                   const double cr, const double sr, const double x, const double y)
+{
+    const double dx = x-px;
+    const double dy = y-py;
+    double u = std::abs(cr*dx+sr*dy);
+    double v = std::abs(cr*dy-sr*dx);
+    if(u==0.0 && v==0.0)
+    {
+        u = std::abs(cr);
+        v = std::abs(sr);
+    }
+    const double f = v/(u+v)*bb_profile_size;
+    const int32_t i = std::min(int32_t(f), bb_profile_size-1);
+    const double w = f-i;
+    return prof[i]+w*(prof[i+1]-prof[i]);
+}
+
+}
+
+#endif // GEOMKERNELS_H
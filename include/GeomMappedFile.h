@@ -0,0 +1,76 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomMappedFile.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomMappedFile.
+ */
+
+#ifndef GEOMMAPPEDFILE_H
+#define GEOMMAPPEDFILE_H
+
+#include <cstddef>
+
+namespace simugeom
+{
+
+// read-only memory mapping of a whole file
+class GeomMappedFile
+{
+    public:
+        GeomMappedFile();
+        virtual ~GeomMappedFile();
+
+        GeomMappedFile(const GeomMappedFile&) = delete;
+        GeomMappedFile& operator=(const GeomMappedFile&) = delete;
+
+        int open(const char* fname);
+        void close();
+
+        const char* get_data() const
+        {
+            return data;
+        }
+
+        std::size_t get_size() const
+        {
+            return size;
+        }
+
+        bool get_is_open() const
+        {
+            return is_open;
+        }
+
+    private:
+        const char* data;
+        std::size_t size;
+        bool is_open;
+#if defined(_WIN32)
+        void* hfile;
+        void* hmap;
+#endif
+};
+
+}
+
+#endif // GEOMMAPPEDFILE_H
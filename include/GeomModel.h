@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <random>
+#include <cmath>
 #include "ObjClass.h"
 #include "GeomPose.h"
 
@@ -46,6 +47,10 @@ class GeomModel
 public:
     GeomModel(const std::string _name, const int _oid, const double _rad, const ObjClass& _cls);
     GeomModel(const std::string _name, const int _oid, const Eigen::Vector3d& _rad, const ObjClass& _cls);
+    GeomModel(const GeomModel&) = default;
+    GeomModel(GeomModel&&) = default;
+    GeomModel& operator=(const GeomModel&) = default;
+    GeomModel& operator=(GeomModel&&) = default;
     virtual ~GeomModel();
 
     const std::string& get_name() const
@@ -94,6 +99,7 @@ public:
         radius(0,0) = _radius;
         radius(1,0) = _radius;
         radius(2,0) = _radius;
+        bb_profile.clear();
     }
 
     void set_radius(const double _r0, const double _r1, const double _r2)
@@ -101,22 +107,45 @@ public:
         radius(0,0) = _r0;
         radius(1,0) = _r1;
         radius(2,0) = _r2;
+        bb_profile.clear();
     }
 
     void set_radius(const Eigen::Vector3d& _radius)
     {
         radius = _radius;
+        bb_profile.clear();
+    }
+
+    double get_bb_radius_max() const
+    {
+        // bounds get_bb_radius_from for any direction and either type
+        return std::sqrt(radius(0,0)*radius(0,0)+radius(1,0)*radius(1,0));
     }
 
     double get_bb_radius_from(const double x, const double y) const;
     double get_bb_radius_from(const Eigen::Vector2d xy) const;
+    void get_bb_radius_from(const double* x, const double* y, double* out, const int32_t n) const;
+    double get_bb_radius_from_profile(const double x, const double y) const;
+
+    void build_bb_radius_profile();
+
+    bool has_bb_radius_profile() const
+    {
+        return !bb_profile.empty();
+    }
+
+    const std::vector<double>& get_bb_radius_profile() const
+    {
+        return bb_profile;
+    }
     //double get_bb_radius_from(const Eigen::Vector3d xyz) const;
 
     void perturb(const Eigen::Vector3d delpos, const double delrot);
 
 protected:
+    // in counter mode proposal i is drawn at the site (oid, iter, k0+i)
     void propose_perturb(const int n, const double sigmpos,
-                  const double sigmrot, GeomScene& gsn);
+                  const double sigmrot, GeomScene& gsn, const uint32_t iter = 0, const uint32_t k0 = 0);
 
 private:
     std::string name;
@@ -128,9 +157,11 @@ private:
     ObjClass::GeomType type;
     Eigen::Vector3d radius; // to use bbox later
     int cid;
+    std::vector<double> bb_profile; // cleared by set_radius
 
     friend class GeomScene;
     friend class GeomAnnealer;
+    friend class GeomTempering;
     friend std::ostream& operator <<(std::ostream& out, const GeomModel& m);
 };
 
@@ -0,0 +1,87 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomPairCache.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomPairCache.
+ */
+
+#ifndef GEOMPAIRCACHE_H
+#define GEOMPAIRCACHE_H
+
+#include <vector>
+#include <cstdint>
+#include "GeomSceneSoA.h"
+
+namespace simugeom
+{
+
+class GeomPairCache
+{
+public:
+    GeomPairCache();
+    virtual ~GeomPairCache();
+
+    void resize(const int32_t n);
+    void clear();
+    bool get_is_current(const GeomSceneSoA& soa, const int i) const;
+    void set_current(const GeomSceneSoA& soa, const int i);
+
+    int32_t size() const
+    {
+        return valid.size();
+    }
+
+    double* get_row(const int i)
+    {
+        return cost.data()+std::size_t(i)*valid.size();
+    }
+
+    const double* get_row(const int i) const
+    {
+        return cost.data()+std::size_t(i)*valid.size();
+    }
+
+public:
+    // symmetric intersection plus pair distance costs for the poses the
+    // rows were computed at, and the nearest wall term of each model
+    std::vector<double> cost;
+    std::vector<double> wall;
+    std::vector<uint8_t> valid;
+    // row of a proposed pose of scratch_oid, kept until commit or rollback
+    std::vector<double> scratch;
+    double scratch_wall;
+    double scratch_x, scratch_y, scratch_rot;
+    int scratch_oid;
+    // rows of the poses of proposed_oid last scored at once, one of which
+    // can be moved to the scratch row
+    std::vector<double> proposed, proposed_wall;
+    std::vector<double> proposed_x, proposed_y, proposed_rot;
+    int proposed_oid;
+
+private:
+    std::vector<double> x, y, rot, rx, ry;
+};
+
+}
+
+#endif // GEOMPAIRCACHE_H
@@ -0,0 +1,103 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomPhilox.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomPhilox.
+ */
+
+#ifndef GEOMPHILOX_H
+#define GEOMPHILOX_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace simugeom
+{
+
+// what a stream of random numbers is drawn for, part of its key
+enum class GeomRngDomain : uint32_t {Scatter = 1, Perturb = 2, Accept = 3, Shuffle = 4, Exchange = 5};
+
+// philox4x32-10 counter based generator: each block of four words is a
+// bijection of (key, counter), so the numbers of any counter can be drawn
+// on any thread in any order, and the results do not depend on the
+// number of threads
+class GeomPhilox
+{
+    public:
+        GeomPhilox(const uint32_t _seed = 0) : seed(_seed) {}
+
+        void set_seed(const uint32_t _seed)
+        {
+            seed = _seed;
+        }
+
+        uint32_t get_seed() const
+        {
+            return seed;
+        }
+
+        // the block of counter (ctr0, ..., ctr3) under the key (seed, domain)
+        void get_block(const GeomRngDomain domain, const uint32_t ctr[4], uint32_t out[4]) const;
+
+    private:
+        uint32_t seed;
+};
+
+// the uniforms in (-1, 1) of one draw site, keyed by the domain, the
+// model, the iteration and the proposal, with the last counter word
+// counting the blocks drawn so far
+class GeomPhiloxStream
+{
+    public:
+        GeomPhiloxStream(const GeomPhilox& _gen, const GeomRngDomain _domain, const uint32_t oid,
+                         const uint32_t iter, const uint32_t k) : gen(_gen), domain(_domain), num_left(0)
+        {
+            ctr[0] = 0;
+            ctr[1] = k;
+            ctr[2] = oid;
+            ctr[3] = iter;
+        }
+
+        double get_uniform()
+        {
+            if(num_left==0) refill();
+            return buf[4-(num_left--)];
+        }
+
+        // n uniforms at once, four per block
+        void get_uniforms(double* out, const std::size_t n);
+
+    protected:
+        void refill();
+
+    private:
+        const GeomPhilox& gen;
+        GeomRngDomain domain;
+        uint32_t ctr[4];
+        double buf[4];
+        int num_left;
+};
+
+}
+
+#endif // GEOMPHILOX_H
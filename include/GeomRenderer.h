@@ -30,9 +30,18 @@
 
 #include <initializer_list>
 #include <array>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include <meshlib.h>
+#ifndef SIMUGEOM_NO_SDL
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
+#else
+struct SDL_Renderer;
+struct SDL_Window;
+#endif
+#include "GeomPose.h"
 
 namespace simugeom
 {
@@ -63,18 +72,61 @@ class GeomScene;
 class GeomRenderer
 {
 public:
-    GeomRenderer(const GeomScene& _gs);
+    // Window draws through SDL, Software into an offscreen RGBA buffer
+    enum class Backend {Window, Software};
+
+    GeomRenderer(const GeomScene& _gs, const Backend _backend = Backend::Window);
     virtual ~GeomRenderer();
 
     void render(bool clear=true);
     void generate_mesh();
 
+    int start(const double fps = 30.0);
+    void stop();
+    void publish(const int32_t _curriter, const int32_t _maxiters, const uint8_t _thickness);
+
+    bool get_is_running() const
+    {
+        return is_running.load(std::memory_order_acquire);
+    }
+
     void display();
     int save(const char* fname);
     int export_mesh(const char* fname);
 
+    Backend get_backend() const
+    {
+        return backend;
+    }
+
+    const std::vector<uint8_t>& get_pixels() const
+    {
+        return pixels;
+    }
+
+    int32_t get_width() const
+    {
+        return width;
+    }
+
+    int32_t get_height() const
+    {
+        return height;
+    }
+
 private:
+    // pose snapshot handed from the solver to the render thread
+    struct Snapshot
+    {
+        std::vector<GeomPose> poses;
+        int32_t curriter;
+        int32_t maxiters;
+        uint8_t thickness;
+    };
+
     int initSDL();
+    void draw_models(const std::vector<GeomPose>* poses);
+    void run(const double fps);
     void draw_cuboid(double cx, double cy, double radx, double rady, double angle);
     void draw_ellipsoid(double cx, double cy, double radx, double rady, double angle);
     void draw_axes();
@@ -84,17 +136,32 @@ private:
     { rc = _r; gc = _g; bc = _b; }
     void set_thickness(const uint8_t _t) { thickness = _t; }
     void refresh();
+    void clear_canvas();
+    void draw_line(int x0, int y0, int x1, int y1);
+    void raster_line(int x0, int y0, int x1, int y1, const int t);
+    void raster_text(int x, int y, const char* s);
 
 private:
     SDL_Renderer *renderer;
     SDL_Window *window;
     const GeomScene& gs;
+    Backend backend;
+    int32_t width, height;
+    std::vector<uint8_t> pixels; // rgba, software backend only
     MESH m;
-    bool render_ready;
+    std::atomic<bool> render_ready; // written by the render thread while it runs
     double scale;
     uint8_t thickness, rc, gc, bc;
     int32_t curriter;
     int32_t maxiters;
+
+    // triple buffer, snap_state holds the middle slot and a new-data bit
+    std::array<Snapshot,3> snaps;
+    std::atomic<uint8_t> snap_state;
+    uint8_t snap_back, snap_front;
+    std::atomic<bool> is_running;
+    std::atomic<bool> is_stopping;
+    std::thread worker;
     friend class GeomAnnealer;
 };
 
@@ -35,7 +35,14 @@
 #include "GeomModel.h"
 #include "ObjClass.h"
 #include "ObjClassSet.h"
+#include "ObjClassTable.h"
 #include "GeomValidity.h"
+#include "GeomSceneSoA.h"
+#include "GeomSpatialGrid.h"
+#include "GeomAABBTree.h"
+#include "GeomWallField.h"
+#include "GeomPairCache.h"
+#include "GeomPhilox.h"
 
 namespace simugeom
 {
@@ -43,6 +50,10 @@ namespace simugeom
 class GeomScene
 {
 public:
+    // sequential draws from the mt19937, or counter based ones keyed by
+    // their draw site, which any thread can make independently
+    enum class RngMode {Sequential, Counter};
+
     GeomScene();
     GeomScene(const ObjClassSet& _classes);
     GeomScene(ObjClassSet&& _classes);
@@ -59,12 +70,30 @@ public:
     void set_seed(const uint32_t _seed)
     {
         seed = _seed;
+        rng.seed(seed);
+        philox.set_seed(seed);
+    }
+
+    void set_rng_mode(const RngMode mode)
+    {
+        rng_mode = mode;
+    }
+
+    RngMode get_rng_mode() const
+    {
+        return rng_mode;
     }
 
+    // a uniform in (-1, 1), in counter mode the one of the draw site
+    // (domain, oid, iter, k), the next one of the mt19937 otherwise
+    double get_uniform(const GeomRngDomain domain, const uint32_t oid, const uint32_t iter, const uint32_t k);
+    void shuffle(std::vector<int>& seq, const uint32_t iter);
+
     void set_boundary(const AABB& _bbox)
     {
         bbox = _bbox;
         boundary = Polygon2D(bbox);
+        wfield.clear();
     }
 
     int32_t get_num_classes() const
@@ -126,11 +155,38 @@ public:
     double get_cost_fixed_angle(int oid0, int oid1) const;
 
     double get_cost_total() const;
+    double get_cost_local(int oid) const;
+    double get_cost_local(int oid, const GeomPose& pose) const;
+    void get_cost_local(int oid, const std::vector<GeomPose>& poses, std::vector<double>& costs) const;
+    double get_cost_delta(int oid, const GeomPose& pose);
+
+    void set_pair_cache(const bool enable);
+
+    bool get_pair_cache() const
+    {
+        return use_pair_cache;
+    }
+
+    void keep_cost_local(int oid, int k);
+    void commit_cost_local(int oid);
+    void rollback_cost_local(int oid);
+
+    const std::vector<int32_t>& get_movable_ids() const;
+    const std::vector<int32_t>& get_fixed_ids() const;
 
     void scatter();
 
 protected:
-     const GeomPose generate_random_pose();
+     const GeomPose generate_random_pose(const int oid);
+     double get_cost_intersect(const GeomSceneSoA& s, int oid0, int oid1) const;
+     double get_cost_pair_dist(const GeomSceneSoA& s, int oid0, int oid1) const;
+     double get_cost_nearest_wall(const GeomSceneSoA& s, int oid, const bool is_scan = false) const;
+     double get_cost_visibility_of_pair(const GeomSceneSoA& s, int oid0, int oid1, std::vector<int>& cands) const;
+     void update_index() const;
+     double get_cost_pair_row(const GeomSceneSoA& s, int oid, double* row) const;
+     double get_cost_local_pairs(int oid) const;
+     double get_cost_local_of(const GeomSceneSoA& s, int oid, const bool use_cache) const;
+     void refresh_pair_cache(int except) const;
 
 private:
     ObjClassSet classes;
@@ -140,11 +196,23 @@ private:
     uint32_t seed;
     std::mt19937 rng;
     std::uniform_real_distribution<double> unidist;
+    GeomPhilox philox;
+    RngMode rng_mode;
+    uint32_t num_scatters;
     AABB bbox;
     Polygon2D boundary;
+    bool use_pair_cache;
+    mutable ObjClassTable ctable;
+    mutable GeomSceneSoA soa;
+    mutable GeomSpatialGrid grid;
+    mutable GeomAABBTree tree;
+    mutable GeomWallField wfield;
+    mutable GeomPairCache pcache;
     friend class GeomSceneReader;
     friend class GeomSceneWriter;
     friend class GeomAnnealer;
+    friend class GeomAnnealerEnsemble;
+    friend class GeomTempering;
     friend class GeomModel;
     friend class GeomRenderer;
 };
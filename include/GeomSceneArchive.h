@@ -0,0 +1,85 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSceneArchive.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomSceneArchive.
+ */
+
+#ifndef GEOMSCENEARCHIVE_H
+#define GEOMSCENEARCHIVE_H
+
+#include "GeomScene.h"
+#include "GeomMappedFile.h"
+#include <fstream>
+
+namespace simugeom
+{
+
+// many scenes in one file: the .gscn records back to back, then a footer
+// of num_scenes+1 uint64 offsets, the uint64 count and an 8 byte magic
+class GeomSceneArchiveWriter
+{
+    public:
+        GeomSceneArchiveWriter();
+        virtual ~GeomSceneArchiveWriter();
+
+        int open(const char* fname);
+        int append(const GeomScene& gs);
+        int close();
+
+        int64_t get_num_scenes() const
+        {
+            return offsets.size();
+        }
+
+    private:
+        std::ofstream ofs;
+        std::vector<uint64_t> offsets;
+        std::vector<char> buf;
+};
+
+class GeomSceneArchiveReader
+{
+    public:
+        GeomSceneArchiveReader();
+        virtual ~GeomSceneArchiveReader();
+
+        int open(const char* fname);
+        void close();
+        int get_scene_data(const int64_t n, const char*& data, std::size_t& size) const;
+        int read(const int64_t n, GeomScene& gs) const;
+
+        int64_t get_num_scenes() const
+        {
+            return num_scenes;
+        }
+
+    private:
+        GeomMappedFile mfile;
+        const uint64_t* offsets; // points into the mapping
+        int64_t num_scenes;
+};
+
+}
+
+#endif // GEOMSCENEARCHIVE_H
@@ -29,10 +29,45 @@
 #define GEOMSCENEIO_H
 
 #include "GeomScene.h"
+#include <iostream>
 
 namespace simugeom
 {
 
+// v2 layout, all sections at fixed offsets given in the header:
+// header | class records | class parameter records | reco angles |
+// model records | pose records (32 byte aligned) | string table
+// the meta crc covers all but the poses, which have their own crc so
+// that they can be rewritten in place
+struct GeomSceneHeader
+{
+    char magic[4]; // "GSCN"
+    uint16_t version;
+    uint16_t bom; // 0xFEFF as written, byte swapped files are refused
+    uint32_t header_size;
+    uint32_t flags;
+    double param_alpha;
+    uint32_t seed;
+    int32_t num_classes;
+    int32_t num_models;
+    uint32_t num_angles;
+    uint64_t class_offset;
+    uint64_t param_offset;
+    uint64_t angle_offset;
+    uint64_t model_offset;
+    uint64_t pose_offset;
+    uint64_t string_offset;
+    uint64_t file_size;
+    uint32_t crc_meta;
+    uint32_t crc_poses;
+    uint8_t reserved[24];
+};
+
+struct GeomPoseRecord
+{
+    double x, y, z, rot;
+};
+
 class GeomSceneReader
 {
     public:
@@ -40,8 +75,15 @@ class GeomSceneReader
         virtual ~GeomSceneReader();
 
         int read(const char* fname);
+        int read(std::istream& is);
+        int read(const char* data, const std::size_t size);
+
+        static const GeomPoseRecord* get_pose_records(const char* data, const std::size_t size, int32_t& num_models);
 
     private:
+        int read_v1(const char* data, const std::size_t size);
+        int read_v2(const char* data, const std::size_t size);
+
         GeomScene& gs;
 };
 
@@ -52,9 +94,22 @@ class GeomSceneWriter
         virtual ~GeomSceneWriter();
 
         int write(const char* fname);
+        int write(std::ostream& os);
+        int write(const int fd);
+        int write_poses(const char* fname);
+        void serialize(std::vector<char>& buf) const;
+        std::size_t get_size() const;
+
+        void set_version(const int _version) { version = _version; }
+        int get_version() const { return version; }
 
     private:
+        void serialize_v1(std::vector<char>& buf) const;
+        void serialize_v2(std::vector<char>& buf) const;
+        std::size_t get_size_v1() const;
+
         const GeomScene& gs;
+        int version;
 };
 
 }
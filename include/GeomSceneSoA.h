@@ -0,0 +1,75 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSceneSoA.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomSceneSoA.
+ */
+
+#ifndef GEOMSCENESOA_H
+#define GEOMSCENESOA_H
+
+#include <vector>
+#include <cstdint>
+#include "GeomModel.h"
+#include "ObjClassSet.h"
+
+namespace simugeom
+{
+
+class GeomSceneSoA
+{
+public:
+    GeomSceneSoA();
+    virtual ~GeomSceneSoA();
+
+    void build(const std::vector<GeomModel>& models, const ObjClassSet& classes);
+    void sync(const std::vector<GeomModel>& models, const ObjClassSet& classes, std::vector<int>& changed);
+    void set_pose(const int i, const GeomPose& pose);
+
+    int32_t size() const
+    {
+        return x.size();
+    }
+
+    bool get_is_fixed(const int i) const
+    {
+        return (is_fixed[i>>6]>>(i&63))&1u;
+    }
+
+public:
+    std::vector<double> x, y, rot, rx, ry, radmax;
+    // cos/sin of rot and the bb radius towards the own centre
+    std::vector<double> cr, sr, rself;
+    std::vector<int32_t> cid;
+    std::vector<ObjClass::GeomType> type;
+    std::vector<uint64_t> is_fixed;
+    // oids of the movable and of the fixed models, ascending
+    std::vector<int32_t> movable, fixed;
+
+private:
+    void set(const int i, const GeomModel& model, const ObjClass& cls);
+};
+
+}
+
+#endif // GEOMSCENESOA_H
@@ -0,0 +1,133 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSchedule.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomSchedule.
+ */
+
+#ifndef GEOMSCHEDULE_H
+#define GEOMSCHEDULE_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+namespace simugeom
+{
+
+// what the proposals of one iteration did
+struct GeomScheduleStats
+{
+    int64_t num_proposed;
+    int64_t num_accepted;
+    int64_t num_uphill;
+    int64_t num_uphill_accepted;
+    double sum_uphill;
+};
+
+// gives the temperature and the step scale (relative to the scene size) of
+// every iteration of an annealing run
+class GeomSchedule
+{
+    public:
+        enum class Kind {Custom, Classic, Geometric, Adaptive};
+
+        virtual ~GeomSchedule() {}
+        virtual Kind get_kind() const { return Kind::Custom; }
+        // a copy with its own state, for runs that anneal side by side
+        virtual std::unique_ptr<GeomSchedule> clone() const = 0;
+        virtual void begin(const int32_t maxiters) { (void)maxiters; }
+        // parameters of iteration iter in [1, maxiters]
+        virtual void get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step) = 0;
+        // feedback of the finished iteration
+        virtual void update(const GeomScheduleStats& stats) { (void)stats; }
+        // what a checkpoint needs to continue the schedule: the kind first,
+        // then the parameters and the state, all checked on resume
+        virtual void get_state(std::vector<double>& state) const { state.assign(1, double(get_kind())); }
+        virtual int set_state(const std::vector<double>& state) { return (state.size()==1 && state[0]==double(get_kind()))?0:-1; }
+};
+
+// the original fixed schedule, temp = 1/iter^2 and
+// step = 1-d+d^2(1-d^2) with d the fraction of the run done
+class GeomScheduleClassic : public GeomSchedule
+{
+    public:
+        Kind get_kind() const override { return Kind::Classic; }
+        std::unique_ptr<GeomSchedule> clone() const override { return std::unique_ptr<GeomSchedule>(new GeomScheduleClassic(*this)); }
+        void get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step) override;
+};
+
+// temperature and step scale both decay geometrically over the run
+class GeomScheduleGeometric : public GeomSchedule
+{
+    public:
+        GeomScheduleGeometric(const double _temp_begin, const double _temp_end,
+                              const double _step_begin = 1.0, const double _step_end = 0.01);
+        Kind get_kind() const override { return Kind::Geometric; }
+        std::unique_ptr<GeomSchedule> clone() const override { return std::unique_ptr<GeomSchedule>(new GeomScheduleGeometric(*this)); }
+        void get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step) override;
+        void get_state(std::vector<double>& state) const override;
+        int set_state(const std::vector<double>& state) override;
+
+    private:
+        double temp_begin, temp_end;
+        double step_begin, step_end;
+};
+
+// feedback schedule: the step scale is retuned after every iteration to
+// hold the acceptance ratio at a target, and the temperature to make the
+// uphill acceptance follow a target that decays geometrically over the
+// run; the first temperature is calibrated from the first uphill moves
+class GeomScheduleAdaptive : public GeomSchedule
+{
+    public:
+        GeomScheduleAdaptive(const double _target_accept = 0.2, const double _target_uphill_begin = 0.3,
+                             const double _target_uphill_end = 0.01, const double _gain = 0.2);
+        Kind get_kind() const override { return Kind::Adaptive; }
+        std::unique_ptr<GeomSchedule> clone() const override { return std::unique_ptr<GeomSchedule>(new GeomScheduleAdaptive(*this)); }
+        void begin(const int32_t maxiters) override;
+        void get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step) override;
+        void update(const GeomScheduleStats& stats) override;
+        void get_state(std::vector<double>& state) const override;
+        int set_state(const std::vector<double>& state) override;
+
+        void set_step_range(const double _step_min, const double _step_max)
+        {
+            step_min = _step_min;
+            step_max = _step_max;
+        }
+
+    private:
+        double target_accept;
+        double target_uphill_begin, target_uphill_end;
+        double gain;
+        double step_min, step_max;
+        // current values, their logarithms are what is retuned
+        double log_temp, log_step;
+        double progress;
+        bool is_calibrated;
+};
+
+}
+
+#endif // GEOMSCHEDULE_H
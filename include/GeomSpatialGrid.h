@@ -0,0 +1,78 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSpatialGrid.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomSpatialGrid.
+ */
+
+#ifndef GEOMSPATIALGRID_H
+#define GEOMSPATIALGRID_H
+
+#include <vector>
+#include <cstdint>
+#include "GeomSceneSoA.h"
+
+namespace simugeom
+{
+
+class GeomSpatialGrid
+{
+public:
+    GeomSpatialGrid();
+    virtual ~GeomSpatialGrid();
+
+    void build(const GeomSceneSoA& soa);
+    void update(const GeomSceneSoA& soa, const int oid);
+    void query(const double x, const double y, const double r, std::vector<int>& oids) const;
+
+    double get_cell_size() const
+    {
+        return cell_size;
+    }
+
+    double get_radius(const int oid) const
+    {
+        return entries[oid].rad;
+    }
+
+private:
+    struct Entry
+    {
+        double x, y, rad;
+        int32_t ix0, iy0, ix1, iy1;
+    };
+
+    int32_t get_cell(const double v) const;
+    uint32_t get_bucket(const int32_t ix, const int32_t iy) const;
+    void insert_entry(const int oid);
+    void remove_entry(const int oid);
+
+    double cell_size;
+    uint32_t bucket_mask;
+    std::vector<Entry> entries;
+    std::vector<std::vector<int>> buckets;
+};
+
+}
+
+#endif // GEOMSPATIALGRID_H
@@ -0,0 +1,91 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomTempering.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomTempering.
+ */
+
+#ifndef GEOMTEMPERING_H
+#define GEOMTEMPERING_H
+
+#include "GeomScene.h"
+#include "GeomTrace.h"
+
+namespace simugeom
+{
+
+// parallel tempering: replicas of the scene sampled at a ladder of fixed
+// temperatures, adjacent replicas exchange their temperatures
+class GeomTempering
+{
+    public:
+        GeomTempering(GeomScene& _gsn, const int32_t _num_replicas = 4);
+        virtual ~GeomTempering();
+
+        void set_num_replicas(const int32_t n) { num_replicas = n; }
+        void set_temperatures(const double _tmin, const double _tmax);
+        void set_swap_interval(const int32_t n) { swap_interval = n; }
+        void set_maxiters(const int32_t _maxiters = 500);
+        void initialise();
+        void iterate();
+        void solve();
+        // one record per round, the cost of the coldest replica as cost_new
+        void set_trace_sink(GeomTraceSink* _trace);
+
+        double get_cost_best() const
+        {
+            return cost_best;
+        }
+
+        double get_swap_rate() const
+        {
+            return (num_swaps>0)?(double(num_swaps_accepted)/num_swaps):0.0;
+        }
+
+    protected:
+        void sweep(const int32_t r);
+        void exchange();
+        void upload_best_solution();
+
+    private:
+        GeomScene& gsn;
+        std::vector<GeomScene> replicas;
+        std::vector<double> temps; // coldest first
+        std::vector<int32_t> slot; // replica at each temperature
+        std::vector<int32_t> level; // temperature of each replica
+        std::vector<double> costs, bests;
+        std::vector<std::vector<GeomPose> > pose_bests;
+        double tmin, tmax;
+        double cost_best;
+        int32_t num_replicas;
+        int32_t swap_interval;
+        int32_t curr_iter;
+        int32_t maxiters;
+        int64_t num_swaps, num_swaps_accepted;
+        std::vector<GeomPose> pose_best;
+        GeomTraceSink* trace;
+};
+
+}
+
+#endif // GEOMTEMPERING_H
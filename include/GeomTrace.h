@@ -0,0 +1,149 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomTrace.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomTrace.
+ */
+
+#ifndef GEOMTRACE_H
+#define GEOMTRACE_H
+
+#include <cstdint>
+#include <vector>
+#include <fstream>
+
+namespace simugeom
+{
+
+// cost of the chain before one proposal step
+struct GeomTraceRecord
+{
+    int64_t step;
+    double cost_new;
+    double cost_best;
+};
+
+// receives the cost trace of one run while it goes, a sink belongs to a
+// single annealer at a time
+class GeomTraceSink
+{
+    public:
+        virtual ~GeomTraceSink() {}
+        // num_steps is the planned length of the run
+        virtual void begin(const int64_t num_steps) { (void)num_steps; }
+        virtual void push(const GeomTraceRecord& rec) = 0;
+        virtual void end() {}
+};
+
+// streams the records as "step cost_new cost_best" text lines, the format
+// of the former export_cost_graph
+class GeomTraceTextSink : public GeomTraceSink
+{
+    public:
+        GeomTraceTextSink(const char* fname);
+        void push(const GeomTraceRecord& rec) override;
+        void end() override;
+
+        bool get_is_open() const
+        {
+            return ofs.is_open();
+        }
+
+    private:
+        std::ofstream ofs;
+};
+
+// streams the records to a binary file, an 8 byte magic "GTRACE01"
+// followed by packed GeomTraceRecords, written in blocks
+class GeomTraceFileSink : public GeomTraceSink
+{
+    public:
+        GeomTraceFileSink(const char* fname, const std::size_t _block_size = 4096);
+        virtual ~GeomTraceFileSink();
+        void push(const GeomTraceRecord& rec) override;
+        void end() override;
+
+        bool get_is_open() const
+        {
+            return ofs.is_open();
+        }
+
+    private:
+        std::ofstream ofs;
+        std::size_t block_size;
+        std::vector<GeomTraceRecord> block;
+};
+
+// keeps the last capacity records in memory
+class GeomTraceRingSink : public GeomTraceSink
+{
+    public:
+        GeomTraceRingSink(const std::size_t _capacity);
+        void begin(const int64_t num_steps) override;
+        void push(const GeomTraceRecord& rec) override;
+        // the kept records, oldest first
+        void get_records(std::vector<GeomTraceRecord>& recs) const;
+
+        int64_t get_num_pushed() const
+        {
+            return num_pushed;
+        }
+
+    private:
+        std::vector<GeomTraceRecord> ring;
+        int64_t num_pushed;
+};
+
+// min/max of a range of steps
+struct GeomTraceBucket
+{
+    int64_t step_first;
+    int64_t num_steps;
+    double cost_new_min, cost_new_max;
+    double cost_best_min, cost_best_max;
+};
+
+// reduces the whole run to at most num_buckets equal ranges of steps,
+// the range doubles whenever the run outgrows the buckets
+class GeomTraceDownsampleSink : public GeomTraceSink
+{
+    public:
+        GeomTraceDownsampleSink(const std::size_t _num_buckets = 1024);
+        void begin(const int64_t num_steps) override;
+        void push(const GeomTraceRecord& rec) override;
+        int export_buckets(const char* fname) const;
+
+        const std::vector<GeomTraceBucket>& get_buckets() const
+        {
+            return buckets;
+        }
+
+    private:
+        std::size_t num_buckets;
+        int64_t width;
+        std::vector<GeomTraceBucket> buckets;
+};
+
+}
+
+#endif // GEOMTRACE_H
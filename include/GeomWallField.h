@@ -0,0 +1,76 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomWallField.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of GeomWallField.
+ */
+
+#ifndef GEOMWALLFIELD_H
+#define GEOMWALLFIELD_H
+
+#include <vector>
+#include <cstdint>
+#include "GeomSceneSoA.h"
+#include "GeomValidity.h"
+
+namespace simugeom
+{
+
+class GeomWallField
+{
+public:
+    GeomWallField();
+    virtual ~GeomWallField();
+
+    void build(const GeomSceneSoA& soa, const AABB& bbox, const bool has_bbox);
+    int query_nearest(const GeomSceneSoA& soa, const int oid, double& dist, const bool is_scan = false) const;
+
+    void clear()
+    {
+        is_built = false;
+    }
+
+    bool get_is_built() const
+    {
+        return is_built;
+    }
+
+    int32_t get_num_cells() const
+    {
+        return nx*ny;
+    }
+
+private:
+    bool is_built;
+    double x0, y0, cell_size;
+    int32_t nx, ny;
+    std::vector<int32_t> fixed; // all fixed oids, ascending
+    // candidate nearest fixed oids of cell c, ascending, are
+    // cands[offsets[c]] to cands[offsets[c+1]-1]
+    std::vector<int32_t> offsets;
+    std::vector<int32_t> cands;
+};
+
+}
+
+#endif // GEOMWALLFIELD_H
@@ -37,6 +37,7 @@ namespace simugeom
 {
 
 class ObjClass;
+class ObjClassTable;
 class GeomSceneReader;
 
 class ObjClassSet
@@ -51,6 +52,9 @@ public:
     {
         return this->insert(ObjClass(std::forward<Args>(args)...));
     }
+    int insert_bulk(const std::vector<ObjClass>& objclss);
+    void reserve(const int32_t num_classes);
+    void compile(ObjClassTable& table) const;
 
     const ObjClass& get_class(const int cid) const
     {
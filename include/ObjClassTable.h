@@ -0,0 +1,85 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file ObjClassTable.h
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This header file contains declarations of all functions and classes of ObjClassTable.
+ */
+
+#ifndef OBJCLASSTABLE_H
+#define OBJCLASSTABLE_H
+
+#include <vector>
+#include <cstdint>
+
+namespace simugeom
+{
+
+class ObjClassSet;
+
+class ObjClassTable
+{
+public:
+    ObjClassTable();
+    virtual ~ObjClassTable();
+
+    int32_t get_num_classes() const
+    {
+        return num_classes;
+    }
+
+    double get_max_reco_dist(const int32_t cid0, const int32_t cid1) const
+    {
+        return max_reco_dist[cid0*num_classes+cid1];
+    }
+
+    double get_reco_dist(const int32_t cid0, const int32_t cid1) const
+    {
+        return reco_dist[cid0*num_classes+cid1];
+    }
+
+    int32_t get_num_reco_angles(const int32_t cid0, const int32_t cid1) const
+    {
+        const int32_t p = cid0*num_classes+cid1;
+        return angle_offsets[p+1]-angle_offsets[p];
+    }
+
+    const double* get_reco_angles(const int32_t cid0, const int32_t cid1) const
+    {
+        return angles.data()+angle_offsets[cid0*num_classes+cid1];
+    }
+
+private:
+    // row-major num_classes x num_classes arrays, angles of pair p are
+    // angles[angle_offsets[p]] to angles[angle_offsets[p+1]-1]
+    int32_t num_classes;
+    std::vector<double> max_reco_dist;
+    std::vector<double> reco_dist;
+    std::vector<int32_t> angle_offsets;
+    std::vector<double> angles;
+
+    friend class ObjClassSet;
+};
+
+}
+
+#endif // OBJCLASSTABLE_H
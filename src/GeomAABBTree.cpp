@@ -0,0 +1,390 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomAABBTree.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomAABBTree.
+ */
+
+#include "../include/GeomAABBTree.h"
+#include <cmath>
+#include <algorithm>
+
+namespace simugeom
+{
+
+// leaves of movable models are enlarged by this fraction of their size,
+// so that small moves only have to check containment
+static constexpr double fat_margin = 0.2;
+// covers the rounding of the bb radii against the boxes
+static constexpr double box_slack = 1.0+1e-9;
+
+GeomAABBTree::GeomAABBTree() : root(-1), free_list(-1)
+{
+}
+
+GeomAABBTree::~GeomAABBTree()
+{
+}
+
+GeomAABBTree::Box GeomAABBTree::get_union(const Box& a, const Box& b)
+{
+    return Box{std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+}
+
+double GeomAABBTree::get_perimeter(const Box& b)
+{
+    return 2.0*((b.x1-b.x0)+(b.y1-b.y0));
+}
+
+bool GeomAABBTree::is_overlapping(const Box& a, const Box& b)
+{
+    return (a.x0<=b.x1 && b.x0<=a.x1 && a.y0<=b.y1 && b.y0<=a.y1);
+}
+
+bool GeomAABBTree::is_containing(const Box& a, const Box& b)
+{
+    return (a.x0<=b.x0 && a.y0<=b.y0 && b.x1<=a.x1 && b.y1<=a.y1);
+}
+
+GeomAABBTree::Box GeomAABBTree::get_tight_box(const GeomSceneSoA& soa, const int oid)
+{
+    // a box holding every point the intersection terms can reach:
+    // fixed models are tested with their bb radii, the others with
+    // get_bb_radius_max in get_cost_bb_intersect_diag
+    double hx, hy;
+    if(!soa.get_is_fixed(oid))
+    {
+        hx = hy = soa.radmax[oid];
+    }
+    else if(soa.type[oid]==ObjClass::GeomType::Cuboid)
+    {
+        const double cs = std::abs(std::cos(soa.rot[oid]));
+        const double sn = std::abs(std::sin(soa.rot[oid]));
+        hx = soa.rx[oid]*cs+soa.ry[oid]*sn;
+        hy = soa.rx[oid]*sn+soa.ry[oid]*cs;
+    }
+    else
+    {
+        hx = hy = std::max(soa.rx[oid], soa.ry[oid]);
+    }
+    hx *= box_slack;
+    hy *= box_slack;
+    return Box{soa.x[oid]-hx, soa.y[oid]-hy, soa.x[oid]+hx, soa.y[oid]+hy};
+}
+
+int32_t GeomAABBTree::alloc_node()
+{
+    if(free_list>=0)
+    {
+        const int32_t n = free_list;
+        free_list = nodes[n].parent;
+        return n;
+    }
+    nodes.emplace_back();
+    return nodes.size()-1;
+}
+
+void GeomAABBTree::free_node(const int32_t n)
+{
+    nodes[n].parent = free_list;
+    nodes[n].height = -1;
+    free_list = n;
+}
+
+void GeomAABBTree::build(const GeomSceneSoA& soa)
+{
+    const int32_t num_models = soa.size();
+    root = -1;
+    free_list = -1;
+    nodes.clear();
+    nodes.reserve(2*num_models);
+    leaves.resize(num_models);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        leaves[i].node = -1;
+        update(soa, i);
+    }
+}
+
+void GeomAABBTree::update(const GeomSceneSoA& soa, const int oid)
+{
+    Leaf& l = leaves[oid];
+    l.is_fixed = soa.get_is_fixed(oid);
+    l.tight = get_tight_box(soa, oid);
+
+    if(l.node>=0)
+    {
+        // still inside its fat box, nothing to restructure
+        if(is_containing(nodes[l.node].box, l.tight)) return;
+        remove_leaf(l.node);
+    }
+    else
+    {
+        l.node = alloc_node();
+    }
+    Node& n = nodes[l.node];
+    n.box = l.tight;
+    if(!l.is_fixed)
+    {
+        const double m = fat_margin*std::max(l.tight.x1-l.tight.x0, l.tight.y1-l.tight.y0);
+        n.box.x0 -= m;
+        n.box.y0 -= m;
+        n.box.x1 += m;
+        n.box.y1 += m;
+    }
+    n.parent = -1;
+    n.child0 = -1;
+    n.child1 = -1;
+    n.height = 0;
+    n.oid = oid;
+    insert_leaf(l.node);
+}
+
+void GeomAABBTree::insert_leaf(const int32_t leaf)
+{
+    if(root<0)
+    {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // find the cheapest sibling by the perimeter heuristic
+    const Box leaf_box = nodes[leaf].box;
+    int32_t index = root;
+    while(!nodes[index].is_leaf())
+    {
+        const int32_t child0 = nodes[index].child0;
+        const int32_t child1 = nodes[index].child1;
+        const double area = get_perimeter(nodes[index].box);
+        const double combined = get_perimeter(get_union(nodes[index].box, leaf_box));
+        const double cost = 2.0*combined;
+        const double inheritance = 2.0*(combined-area);
+
+        double cost0 = get_perimeter(get_union(leaf_box, nodes[child0].box))+inheritance;
+        if(!nodes[child0].is_leaf()) cost0 -= get_perimeter(nodes[child0].box);
+        double cost1 = get_perimeter(get_union(leaf_box, nodes[child1].box))+inheritance;
+        if(!nodes[child1].is_leaf()) cost1 -= get_perimeter(nodes[child1].box);
+
+        if(cost<cost0 && cost<cost1) break;
+        index = (cost0<cost1)?child0:child1;
+    }
+    const int32_t sibling = index;
+
+    const int32_t old_parent = nodes[sibling].parent;
+    const int32_t new_parent = alloc_node();
+    Node& np = nodes[new_parent];
+    np.parent = old_parent;
+    np.box = get_union(leaf_box, nodes[sibling].box);
+    np.height = nodes[sibling].height+1;
+    np.oid = -1;
+    np.child0 = sibling;
+    np.child1 = leaf;
+    if(old_parent>=0)
+    {
+        if(nodes[old_parent].child0==sibling) nodes[old_parent].child0 = new_parent;
+        else nodes[old_parent].child1 = new_parent;
+    }
+    else
+    {
+        root = new_parent;
+    }
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    refit(nodes[leaf].parent);
+}
+
+void GeomAABBTree::remove_leaf(const int32_t leaf)
+{
+    if(leaf==root)
+    {
+        root = -1;
+        return;
+    }
+    const int32_t parent = nodes[leaf].parent;
+    const int32_t grand_parent = nodes[parent].parent;
+    const int32_t sibling = (nodes[parent].child0==leaf)?nodes[parent].child1:nodes[parent].child0;
+    if(grand_parent>=0)
+    {
+        if(nodes[grand_parent].child0==parent) nodes[grand_parent].child0 = sibling;
+        else nodes[grand_parent].child1 = sibling;
+        nodes[sibling].parent = grand_parent;
+        free_node(parent);
+        refit(grand_parent);
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        free_node(parent);
+    }
+}
+
+void GeomAABBTree::refit(int32_t n)
+{
+    // walk back up fixing the heights and boxes
+    while(n>=0)
+    {
+        n = balance(n);
+        Node& nd = nodes[n];
+        nd.height = 1+std::max(nodes[nd.child0].height, nodes[nd.child1].height);
+        nd.box = get_union(nodes[nd.child0].box, nodes[nd.child1].box);
+        n = nd.parent;
+    }
+}
+
+int32_t GeomAABBTree::balance(const int32_t a)
+{
+    // rotates the higher child up if the subtree of a is unbalanced
+    Node& na = nodes[a];
+    if(na.is_leaf() || na.height<2) return a;
+
+    const int32_t b = na.child0;
+    const int32_t c = na.child1;
+    Node& nb = nodes[b];
+    Node& nc = nodes[c];
+    const int32_t bal = nc.height-nb.height;
+
+    if(bal>1)
+    {
+        // rotate c up
+        const int32_t f = nc.child0;
+        const int32_t g = nc.child1;
+        nc.child0 = a;
+        nc.parent = na.parent;
+        na.parent = c;
+        if(nc.parent>=0)
+        {
+            if(nodes[nc.parent].child0==a) nodes[nc.parent].child0 = c;
+            else nodes[nc.parent].child1 = c;
+        }
+        else
+        {
+            root = c;
+        }
+        const int32_t hi = (nodes[f].height>nodes[g].height)?f:g;
+        const int32_t lo = (hi==f)?g:f;
+        nc.child1 = hi;
+        na.child1 = lo;
+        nodes[lo].parent = a;
+        na.box = get_union(nb.box, nodes[lo].box);
+        nc.box = get_union(na.box, nodes[hi].box);
+        na.height = 1+std::max(nb.height, nodes[lo].height);
+        nc.height = 1+std::max(na.height, nodes[hi].height);
+        return c;
+    }
+    if(bal<-1)
+    {
+        // rotate b up
+        const int32_t d = nb.child0;
+        const int32_t e = nb.child1;
+        nb.child0 = a;
+        nb.parent = na.parent;
+        na.parent = b;
+        if(nb.parent>=0)
+        {
+            if(nodes[nb.parent].child0==a) nodes[nb.parent].child0 = b;
+            else nodes[nb.parent].child1 = b;
+        }
+        else
+        {
+            root = b;
+        }
+        const int32_t hi = (nodes[d].height>nodes[e].height)?d:e;
+        const int32_t lo = (hi==d)?e:d;
+        nb.child1 = hi;
+        na.child0 = lo;
+        nodes[lo].parent = a;
+        na.box = get_union(nc.box, nodes[lo].box);
+        nb.box = get_union(na.box, nodes[hi].box);
+        na.height = 1+std::max(nc.height, nodes[lo].height);
+        nb.height = 1+std::max(na.height, nodes[hi].height);
+        return b;
+    }
+    return a;
+}
+
+void GeomAABBTree::query_box(const Box& box, const int oid, std::vector<int>& oids) const
+{
+    if(root<0) return;
+    const bool is_fixed = leaves[oid].is_fixed;
+    int32_t stack[128];
+    int32_t top = 0;
+    stack[top++] = root;
+    while(top>0)
+    {
+        const Node& n = nodes[stack[--top]];
+        if(!is_overlapping(n.box, box)) continue;
+        if(n.is_leaf())
+        {
+            if(n.oid==oid) continue;
+            const Leaf& l = leaves[n.oid];
+            // fixed pairs carry no cost
+            if(is_fixed && l.is_fixed) continue;
+            if(is_overlapping(l.tight, box)) oids.push_back(n.oid);
+        }
+        else
+        {
+            stack[top++] = n.child0;
+            stack[top++] = n.child1;
+        }
+    }
+}
+
+void GeomAABBTree::query(const int oid, std::vector<int>& oids) const
+{
+    // models whose boxes overlap the box of oid, in increasing order
+    oids.clear();
+    query_box(leaves[oid].tight, oid, oids);
+    std::sort(oids.begin(), oids.end());
+}
+
+void GeomAABBTree::query(const GeomSceneSoA& soa, const int oid, std::vector<int>& oids) const
+{
+    // same as above for the pose of oid in soa, which may differ from the
+    // indexed one
+    oids.clear();
+    query_box(get_tight_box(soa, oid), oid, oids);
+    std::sort(oids.begin(), oids.end());
+}
+
+void GeomAABBTree::query_pairs(std::vector<std::pair<int, int>>& pairs) const
+{
+    // all overlapping pairs (i, j) with i<j, in increasing order
+    pairs.clear();
+    std::vector<int> oids;
+    const int32_t num_leaves = leaves.size();
+    for(int32_t i=0; i<num_leaves; ++i)
+    {
+        oids.clear();
+        query_box(leaves[i].tight, i, oids);
+        for(const int j : oids)
+        {
+            if(i<j) pairs.emplace_back(i, j);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
+
+}
@@ -26,11 +26,17 @@
  */
 
 #include "../include/GeomAnnealer.h"
+#include "../include/GeomSceneIO.h"
+#include "../include/GeomChecksum.h"
 #include <omp.h>
 #include <limits>
 #include <meshlib.h>
 #include <numeric>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
 
 namespace simugeom
 {
@@ -41,7 +47,9 @@ GeomAnnealer::GeomAnnealer(GeomScene& _gsn) : gsn(_gsn),
     cost_best(std::numeric_limits<double>::max()),
     alpha(1.0), beta(std::numeric_limits<double>::max()),
     sigmpos(0.5), sigmrot(0.5), curr_iter(-1), maxiters(500), num_proposals(1),
-    pose_best(gsn.get_models().size()), has_renderer(false), grdr(nullptr)
+    proposal_mode(ProposalMode::Sequential),
+    pose_best(gsn.get_models().size()), schedule(&schedule_classic), has_renderer(false), grdr(nullptr), trace(nullptr), ckpt_interval(0),
+    shared_best(nullptr), abort_margin(0.25), stop_reason(StopReason::MaxIters), iter_improved(0)
 {
 }
 
@@ -72,8 +80,8 @@ void GeomAnnealer::upload_best_solution()
 void GeomAnnealer::set_renderer(GeomRenderer& _grdr)
 {
     grdr = &_grdr;
-    has_renderer = true;
-    grdr->initSDL();
+    // the window is drawn on its own thread from published snapshots
+    has_renderer = (grdr->start()==0);
 }
 
 void GeomAnnealer::initialise()
@@ -84,116 +92,491 @@ void GeomAnnealer::initialise()
     cost_new = cost_old;
     cost_best = cost_new;
     download_best_solution();
+    schedule->begin(maxiters);
+    iter_improved = 0;
+    best_ring.assign(std::max(stop.converge_window, 0), cost_best);
     if(has_renderer)
     {
-        grdr->set_thickness(3);
-        grdr->set_iteration(curr_iter, maxiters);
-        grdr->render(true);
+        grdr->publish(curr_iter, maxiters, 3);
     }
 }
 
-void GeomAnnealer::iterate(const double beta2)
+void GeomAnnealer::iterate()
 {
     ++curr_iter;
-    beta = 1.0/(double(curr_iter)*curr_iter);
-    // generate random permutation sequence for one epoch
-    const int num_models = gsn.get_models().size();
-    std::vector<int> seq(num_models);
-    std::iota(std::begin(seq), std::end(seq), 0);
-    std::shuffle(std::begin(seq), std::end(seq), gsn.rng);
+    double step;
+    schedule->get_params(curr_iter, maxiters, beta, step);
+    stats = GeomScheduleStats();
+    // generate random permutation sequence of the movable models for one epoch
+    std::vector<int> seq(gsn.get_movable_ids().begin(), gsn.get_movable_ids().end());
+    const int num_models = seq.size();
+    gsn.shuffle(seq, curr_iter);
     // select one model in order and perturb
-    sigmpos = 0.5*beta2*std::sqrt(gsn.bbox.rad(0,0)*gsn.bbox.rad(0,0)+gsn.bbox.rad(1,0)*gsn.bbox.rad(1,0));
-    sigmrot = 0.5*beta2*MESH_TWOPI;
+    sigmpos = 0.5*step*std::sqrt(gsn.bbox.rad(0,0)*gsn.bbox.rad(0,0)+gsn.bbox.rad(1,0)*gsn.bbox.rad(1,0));
+    sigmrot = 0.5*step*MESH_TWOPI;
     //std::cout<<"[ITER "<<curr_iter<<"]: old: "<<cost_old<<" best: "<<cost_best<<std::endl;
     for(int i=0; i<num_models; ++i)
     {
 
         GeomModel& tmodel = gsn.get_model(seq[i]);
-        const int32_t cindx = i+(curr_iter-1)*num_models;
-        cost_bests[cindx] = cost_best;
-        cost_news[cindx] = cost_new;
+        if(trace)
+        {
+            trace->push({i+int64_t(curr_iter-1)*num_models, cost_new, cost_best});
+        }
 
-        if(gsn.classes.get_class(tmodel.get_class_id()).is_fixed) continue;
-        tmodel.propose_perturb(num_proposals, sigmpos, sigmrot, gsn);
+        if(proposal_mode==ProposalMode::MultipleTry)
+        {
+            iterate_multiple_try(seq[i]);
+            continue;
+        }
 
+        tmodel.propose_perturb(num_proposals, sigmpos, sigmrot, gsn, curr_iter);
 
+        // only the terms touching this model change, so track the total by deltas
+        double cost_local_old = gsn.get_cost_local(seq[i]);
         for(int k=0; k<num_proposals; ++k)
         {
             // for each ith proposal, try
             std::swap(tmodel.pose,tmodel.proposed_poses[k]);
             if(has_renderer)
             {
-                grdr->set_thickness(1);
-                grdr->set_iteration(curr_iter, maxiters);
-                grdr->render(true);
+                grdr->publish(curr_iter, maxiters, 1);
             }
-            cost_new = gsn.get_cost_total();
+            const double cost_local_new = gsn.get_cost_local(seq[i]);
+            cost_new = cost_old+(cost_local_new-cost_local_old);
+            ++stats.num_proposed;
 
             if(cost_new<cost_best)
             {
                 // accept new pose
+                ++stats.num_accepted;
                 cost_best = cost_new;
+                cost_old = cost_new;
+                cost_local_old = cost_local_new;
+                gsn.commit_cost_local(seq[i]);
                 download_best_solution();
                 continue;
             }
             alpha = std::exp((cost_old-cost_new)/beta);
-            if((cost_new<cost_old) || (alpha>0.5*(gsn.unidist(gsn.rng)+1.0)))
+            const bool is_uphill = (cost_new>cost_old);
+            if(is_uphill)
+            {
+                ++stats.num_uphill;
+                stats.sum_uphill += cost_new-cost_old;
+            }
+            if((cost_new<cost_old) || (alpha>0.5*(gsn.get_uniform(GeomRngDomain::Accept, seq[i], curr_iter, k)+1.0)))
             {
+                ++stats.num_accepted;
+                stats.num_uphill_accepted += is_uphill;
                 cost_old = cost_new;
+                cost_local_old = cost_local_new;
+                gsn.commit_cost_local(seq[i]);
             }
             else
             {
                 // retrieve the old solution
                 std::swap(tmodel.pose, tmodel.proposed_poses[k]);
+                gsn.rollback_cost_local(seq[i]);
             }
         }
     }
+    schedule->update(stats);
     if(has_renderer)
     {
-        grdr->set_thickness(3);
-        grdr->set_iteration(curr_iter, maxiters);
-        grdr->render(true);
+        grdr->publish(curr_iter, maxiters, 3);
     }
 }
 
-void GeomAnnealer::export_cost_graph(const char* fname)
+static double log_sum_exp(const std::vector<double>& dcosts, const double beta)
+{
+    // log of sum(exp(-dcost/beta)), shifted by the smallest cost
+    const double dmin = *std::min_element(dcosts.begin(), dcosts.end());
+    double w = 0.0;
+    for(const double d : dcosts) w += std::exp((dmin-d)/beta);
+    return -dmin/beta+std::log(w);
+}
+
+void GeomAnnealer::iterate_multiple_try(const int oid)
 {
-    std::ofstream ofs(fname, std::ios::binary);
-    if(ofs.is_open())
+    // multiple-try metropolis: all proposals are scored at once, one is
+    // drawn by its boltzmann weight and accepted against a reference set
+    // drawn around it, which keeps the chain in detailed balance
+    GeomModel& tmodel = gsn.get_model(oid);
+    const double cost_local_old = gsn.get_cost_local(oid);
+    tmodel.propose_perturb(num_proposals, sigmpos, sigmrot, gsn, curr_iter);
+    gsn.get_cost_local(oid, tmodel.proposed_poses, costs_prop);
+    for(double& c : costs_prop) c -= cost_local_old;
+
+    // select one proposal with probability proportional to its weight
+    const double lwy = log_sum_exp(costs_prop, beta);
+    const double u = 0.5*(gsn.get_uniform(GeomRngDomain::Accept, oid, curr_iter, 0)+1.0);
+    int sel = num_proposals-1;
+    double cdf = 0.0;
+    for(int k=0; k<num_proposals; ++k)
     {
-        const int32_t n = cost_bests.size();
-        for(int32_t i=0; i<n; ++i)
+        cdf += std::exp(-costs_prop[k]/beta-lwy);
+        if(u<cdf)
         {
-            ofs<<i<<" "<<cost_news[i]<<" "<<cost_bests[i]<<"\n";
+            sel = k;
+            break;
         }
     }
+
+    // the pair row of the selected pose is kept for commit_cost_local
+    gsn.keep_cost_local(oid, sel);
+
+    // reference set: k-1 draws around the selected pose and the current one
+    const GeomPose pose_old = tmodel.pose;
+    tmodel.pose = tmodel.proposed_poses[sel];
+    std::swap(ref_poses, tmodel.proposed_poses);
+    tmodel.propose_perturb(num_proposals-1, sigmpos, sigmrot, gsn, curr_iter, num_proposals);
+    std::swap(ref_poses, tmodel.proposed_poses);
+    tmodel.pose = pose_old;
+    gsn.get_cost_local(oid, ref_poses, costs_ref);
+    for(double& c : costs_ref) c -= cost_local_old;
+    costs_ref.push_back(0.0);
+
+    const double dcost = costs_prop[sel];
+    cost_new = cost_old+dcost;
+    const double lwx = log_sum_exp(costs_ref, beta);
+    ++stats.num_proposed;
+    if(dcost>0.0)
+    {
+        ++stats.num_uphill;
+        stats.sum_uphill += dcost;
+    }
+    if(std::log(0.5*(gsn.get_uniform(GeomRngDomain::Accept, oid, curr_iter, 1)+1.0))<(lwy-lwx))
+    {
+        tmodel.pose = tmodel.proposed_poses[sel];
+        ++stats.num_accepted;
+        stats.num_uphill_accepted += (dcost>0.0);
+        cost_old = cost_new;
+        gsn.commit_cost_local(oid);
+        if(cost_new<cost_best)
+        {
+            cost_best = cost_new;
+            download_best_solution();
+        }
+    }
+    else
+    {
+        gsn.rollback_cost_local(oid);
+    }
+    if(has_renderer)
+    {
+        grdr->publish(curr_iter, maxiters, 1);
+    }
+}
+
+void GeomAnnealer::set_trace_sink(GeomTraceSink* _trace)
+{
+    trace = _trace;
 }
 
 void GeomAnnealer::set_maxiters(const int32_t _maxiters)
 {
     maxiters = _maxiters;
 }
-void GeomAnnealer::solve()
+void GeomAnnealer::set_schedule(GeomSchedule* _schedule)
+{
+    schedule = _schedule?_schedule:&schedule_classic;
+}
+
+void GeomAnnealer::set_shared_best(std::atomic<double>* _shared_best, const double _abort_margin)
+{
+    shared_best = _shared_best;
+    abort_margin = _abort_margin;
+}
+
+bool GeomAnnealer::publish_best()
+{
+    // lowers the shared best to ours if it is higher, and tells whether
+    // this run is so far behind it that it should stop
+    double cost_shared = shared_best->load(std::memory_order_relaxed);
+    while((cost_best<cost_shared) && !shared_best->compare_exchange_weak(cost_shared, cost_best, std::memory_order_relaxed))
+    {
+    }
+    return (cost_best-cost_shared)>abort_margin*std::abs(cost_shared);
+}
+
+GeomAnnealer::StopReason GeomAnnealer::solve()
 {
     initialise();
-    cost_bests.resize(maxiters*gsn.get_models().size());
-    cost_news.resize(maxiters*gsn.get_models().size());
-    for(int32_t i=0; i<maxiters; ++i)
-    {
-        const auto d = ((double)i)/maxiters;
-        const auto d2 = d*d;
-        // const auto beta2 = (1.-d);
-        // const auto beta2 = (1.-d2);
-        const auto beta2 = (1.-d+d2*(1-d2));
-        // const auto beta2 = (1.-d2-d2*(d-d2));
-        // other functions
-        // (1-x+x^2-x^4)
-        // (1-x^2-x^3+x^4)
-        iterate(beta2);
+    run();
+    return stop_reason;
+}
+
+bool GeomAnnealer::get_is_stopping(const double best_before, const std::chrono::steady_clock::time_point t0)
+{
+    // checked after every iteration, the first criterion met is the reason
+    if(cost_best<best_before) iter_improved = curr_iter;
+    bool is_converged = false;
+    if(stop.converge_window>0)
+    {
+        // the slot of this iteration holds the best of converge_window ago
+        double& best_old = best_ring[curr_iter%stop.converge_window];
+        is_converged = (curr_iter>=stop.converge_window) && ((best_old-cost_best)<stop.converge_ratio*std::abs(best_old));
+        best_old = cost_best;
+    }
+    if(cost_best<=stop.target_cost)
+    {
+        stop_reason = StopReason::TargetCost;
+    }
+    else if(stop.stall_window>0 && (curr_iter-iter_improved)>=stop.stall_window)
+    {
+        stop_reason = StopReason::Stalled;
+    }
+    else if(is_converged)
+    {
+        stop_reason = StopReason::Converged;
+    }
+    else if(stop.max_seconds>0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count()>=stop.max_seconds)
+    {
+        stop_reason = StopReason::Deadline;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void GeomAnnealer::run()
+{
+    // runs the schedule from the current iteration to its end
+    const auto t0 = std::chrono::steady_clock::now();
+    stop_reason = StopReason::MaxIters;
+    if(trace)
+    {
+        trace->begin(int64_t(maxiters)*gsn.get_movable_ids().size());
+    }
+    for(int32_t i=curr_iter; i<maxiters; ++i)
+    {
+        const double best_before = cost_best;
+        iterate();
+        // a run behind the shared best only stops after the first quarter
+        // of the schedule, while the large steps can still catch up
+        if(shared_best && publish_best() && (i>=maxiters/4))
+        {
+            stop_reason = StopReason::Aborted;
+            break;
+        }
+        if(get_is_stopping(best_before, t0))
+        {
+            break;
+        }
+        if(ckpt_interval>0 && ((i+1)%ckpt_interval)==0 && (i+1)<maxiters)
+        {
+            // only the snapshot is taken here, the writer thread does the io
+            serialize_state(ckpt_buf);
+            ckpt.post(ckpt_buf);
+        }
     }
     upload_best_solution();
+    if(trace)
+    {
+        trace->end();
+    }
+    if(ckpt_interval>0)
+    {
+        ckpt.flush();
+    }
 }
 
+int GeomAnnealer::set_checkpoint(const char* fname, const int32_t interval)
+{
+    ckpt.close();
+    ckpt_interval = 0;
+    if(fname==nullptr || interval<=0) return 0;
+    if(ckpt.open(fname)!=0) return -1;
+    ckpt_interval = interval;
+    return 0;
+}
+
+int GeomAnnealer::save_checkpoint(const char* fname) const
+{
+    std::vector<char> buf;
+    serialize_state(buf);
+    return GeomCheckpointWriter::write_file(fname, buf);
+}
+
+int GeomAnnealer::resume(const char* fname)
+{
+    std::ifstream ifs(fname, std::ios::binary);
+    if(!ifs.is_open()) return -1;
+    const std::vector<char> buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    if(deserialize_state(buf.data(), buf.size())!=0) return -1;
+    if(has_renderer)
+    {
+        grdr->publish(curr_iter, maxiters, 3);
+    }
+    run();
+    return 0;
 }
 
+static const char ckpt_magic[8] = {'G', 'A', 'N', 'C', 'K', 'P', 'T', '4'};
 
+template<typename T>
+static inline void put_field(char*& p, const T& val)
+{
+    std::memcpy(p, &val, sizeof(T));
+    p += sizeof(T);
+}
+
+template<typename T>
+static inline void get_field(const char*& p, T& val)
+{
+    std::memcpy(&val, p, sizeof(T));
+    p += sizeof(T);
+}
+
+static inline GeomPoseRecord get_pose_record(const GeomPose& gp)
+{
+    return {gp.pos(0,0), gp.pos(1,0), gp.pos(2,0), gp.rot};
+}
+
+static inline void set_pose(GeomPose& gp, const GeomPoseRecord& rec)
+{
+    gp.pos(0,0) = rec.x;
+    gp.pos(1,0) = rec.y;
+    gp.pos(2,0) = rec.z;
+    gp.rot = rec.rot;
+}
+
+void GeomAnnealer::serialize_state(std::vector<char>& buf) const
+{
+    // magic | counts, settings and rng mode | chain scalars | current poses |
+    // best poses | rng state as text | schedule state | stopping state |
+    // crc of all before it
+    std::ostringstream oss;
+    oss<<gsn.rng<<" "<<gsn.unidist;
+    const std::string rng_state = oss.str();
+    std::vector<double> sched_state;
+    schedule->get_state(sched_state);
+    const int32_t num_models = gsn.get_models().size();
+    const std::size_t size = sizeof(ckpt_magic)+7*sizeof(int32_t)+sizeof(uint32_t)+7*sizeof(double)
+                             +2*sizeof(GeomPoseRecord)*num_models+sizeof(uint32_t)+rng_state.size()
+                             +sizeof(uint32_t)+sizeof(double)*sched_state.size()
+                             +sizeof(int32_t)+sizeof(uint32_t)+sizeof(double)*best_ring.size()+sizeof(uint32_t);
+    buf.resize(size);
+    char* p = buf.data();
+    std::memcpy(p, ckpt_magic, sizeof(ckpt_magic));
+    p += sizeof(ckpt_magic);
+    put_field(p, num_models);
+    put_field(p, curr_iter);
+    put_field(p, maxiters);
+    put_field(p, num_proposals);
+    put_field(p, int32_t(proposal_mode));
+    put_field(p, int32_t(gsn.seed));
+    put_field(p, int32_t(gsn.rng_mode));
+    put_field(p, gsn.num_scatters);
+    put_field(p, cost_old);
+    put_field(p, cost_new);
+    put_field(p, cost_best);
+    put_field(p, alpha);
+    put_field(p, beta);
+    put_field(p, sigmpos);
+    put_field(p, sigmrot);
+    for(int32_t i=0; i<num_models; ++i) put_field(p, get_pose_record(gsn.get_model(i).pose));
+    for(int32_t i=0; i<num_models; ++i) put_field(p, get_pose_record(pose_best[i]));
+    put_field(p, uint32_t(rng_state.size()));
+    std::memcpy(p, rng_state.data(), rng_state.size());
+    p += rng_state.size();
+    put_field(p, uint32_t(sched_state.size()));
+    for(const double v : sched_state) put_field(p, v);
+    put_field(p, iter_improved);
+    put_field(p, uint32_t(best_ring.size()));
+    for(const double v : best_ring) put_field(p, v);
+    put_field(p, get_crc32(buf.data(), p-buf.data()));
+}
+
+int GeomAnnealer::deserialize_state(const char* data, const std::size_t size)
+{
+    // everything is checked before the state is touched
+    const std::size_t fixed_size = sizeof(ckpt_magic)+7*sizeof(int32_t)+sizeof(uint32_t)+7*sizeof(double);
+    const int32_t num_models_scene = gsn.get_models().size();
+    if(size<fixed_size+sizeof(uint32_t) || std::memcmp(data, ckpt_magic, sizeof(ckpt_magic))!=0) return -1;
+    uint32_t crc;
+    std::memcpy(&crc, data+size-sizeof(uint32_t), sizeof(uint32_t));
+    if(get_crc32(data, size-sizeof(uint32_t))!=crc) return -1;
+    const char* p = data+sizeof(ckpt_magic);
+    int32_t num_models, tcurr_iter, tmaxiters, tnum_proposals, tmode, tseed, trng_mode;
+    uint32_t tnum_scatters;
+    get_field(p, num_models);
+    get_field(p, tcurr_iter);
+    get_field(p, tmaxiters);
+    get_field(p, tnum_proposals);
+    get_field(p, tmode);
+    get_field(p, tseed);
+    get_field(p, trng_mode);
+    get_field(p, tnum_scatters);
+    if(num_models!=num_models_scene || tcurr_iter<0 || tcurr_iter>tmaxiters || tnum_proposals<1) return -1;
+    if(tmode!=int32_t(ProposalMode::Sequential) && tmode!=int32_t(ProposalMode::MultipleTry)) return -1;
+    if(trng_mode!=int32_t(GeomScene::RngMode::Sequential) && trng_mode!=int32_t(GeomScene::RngMode::Counter)) return -1;
+    const std::size_t pose_size = 2*sizeof(GeomPoseRecord)*std::size_t(num_models);
+    if(size-fixed_size-sizeof(uint32_t)<pose_size+sizeof(uint32_t)) return -1;
+    const char* q = p+7*sizeof(double)+pose_size;
+    const char* end = data+size-sizeof(uint32_t);
+    uint32_t rng_size, sched_size;
+    get_field(q, rng_size);
+    if(rng_size>std::size_t(end-q) || std::size_t(end-q)-rng_size<sizeof(uint32_t)) return -1;
+    std::istringstream iss(std::string(q, rng_size));
+    std::mt19937 trng;
+    std::uniform_real_distribution<double> tunidist;
+    iss>>trng>>tunidist;
+    if(iss.fail()) return -1;
+    q += rng_size;
+    get_field(q, sched_size);
+    if(std::size_t(end-q)<sizeof(double)*std::size_t(sched_size)+sizeof(int32_t)+sizeof(uint32_t)) return -1;
+    std::vector<double> sched_state(sched_size);
+    for(double& v : sched_state) get_field(q, v);
+    int32_t titer_improved;
+    uint32_t ring_size;
+    get_field(q, titer_improved);
+    get_field(q, ring_size);
+    if(std::size_t(end-q)!=sizeof(double)*std::size_t(ring_size) || titer_improved<0 || titer_improved>tcurr_iter) return -1;
+    std::vector<double> tbest_ring(ring_size);
+    for(double& v : tbest_ring) get_field(q, v);
+    // the schedule must be of the kind the checkpoint was taken with
+    if(schedule->set_state(sched_state)!=0) return -1;
+
+    curr_iter = tcurr_iter;
+    maxiters = tmaxiters;
+    num_proposals = tnum_proposals;
+    proposal_mode = ProposalMode(tmode);
+    gsn.seed = tseed;
+    gsn.philox.set_seed(tseed);
+    gsn.rng_mode = GeomScene::RngMode(trng_mode);
+    gsn.num_scatters = tnum_scatters;
+    get_field(p, cost_old);
+    get_field(p, cost_new);
+    get_field(p, cost_best);
+    get_field(p, alpha);
+    get_field(p, beta);
+    get_field(p, sigmpos);
+    get_field(p, sigmrot);
+    GeomPoseRecord rec;
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        get_field(p, rec);
+        set_pose(gsn.get_model(i).pose, rec);
+    }
+    pose_best.resize(num_models);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        get_field(p, rec);
+        set_pose(pose_best[i], rec);
+    }
+    gsn.rng = trng;
+    gsn.unidist = tunidist;
+    iter_improved = titer_improved;
+    best_ring.swap(tbest_ring);
+    if(int32_t(best_ring.size())!=std::max(stop.converge_window, 0))
+    {
+        // a different window starts over from the current best
+        best_ring.assign(std::max(stop.converge_window, 0), cost_best);
+    }
+    return 0;
+}
+
+}
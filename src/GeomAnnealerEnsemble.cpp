@@ -0,0 +1,93 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomAnnealerEnsemble.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomAnnealerEnsemble.
+ */
+
+#include "../include/GeomAnnealerEnsemble.h"
+#include <omp.h>
+#include <limits>
+
+namespace simugeom
+{
+
+GeomAnnealerEnsemble::GeomAnnealerEnsemble(GeomScene& _gsn, const int32_t _num_runs) : gsn(_gsn),
+    num_runs(_num_runs), num_proposals(1), maxiters(500), abort_margin(0.25),
+    proposal_mode(GeomAnnealer::ProposalMode::Sequential), schedule(nullptr),
+    cost_best(std::numeric_limits<double>::max()), best_run(-1), num_aborted(0)
+{
+}
+
+GeomAnnealerEnsemble::~GeomAnnealerEnsemble()
+{
+}
+
+void GeomAnnealerEnsemble::solve()
+{
+    // every run gets its own clone of the scene with its own seed drawn
+    // from the scene's generator
+    std::vector<GeomScene> scenes(num_runs, gsn);
+    std::vector<double> costs(num_runs);
+    std::vector<char> is_aborted(num_runs);
+    for(int32_t r=0; r<num_runs; ++r)
+    {
+        scenes[r].set_seed(gsn.rng());
+    }
+    std::atomic<double> shared_best(std::numeric_limits<double>::max());
+    #pragma omp parallel for schedule(dynamic)
+    for(int32_t r=0; r<num_runs; ++r)
+    {
+        GeomAnnealer gan(scenes[r]);
+        std::unique_ptr<GeomSchedule> tschedule(schedule?schedule->clone():nullptr);
+        gan.set_num_proposals(num_proposals);
+        gan.set_proposal_mode(proposal_mode);
+        gan.set_schedule(tschedule.get());
+        gan.set_stop_criteria(stop);
+        gan.set_maxiters(maxiters);
+        gan.set_shared_best(&shared_best, abort_margin);
+        gan.solve();
+        costs[r] = gan.get_cost_best();
+        is_aborted[r] = gan.get_is_aborted();
+    }
+    cost_best = std::numeric_limits<double>::max();
+    best_run = -1;
+    num_aborted = 0;
+    for(int32_t r=0; r<num_runs; ++r)
+    {
+        num_aborted += is_aborted[r];
+        if(costs[r]<cost_best)
+        {
+            cost_best = costs[r];
+            best_run = r;
+        }
+    }
+    if(best_run<0) return;
+    const int num_models = gsn.get_models().size();
+    for(int i=0; i<num_models; ++i)
+    {
+        gsn.get_model(i).set_pose(scenes[best_run].get_model(i).get_pose());
+    }
+}
+
+}
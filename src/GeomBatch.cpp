@@ -0,0 +1,155 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomBatch.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomBatch.
+ */
+
+#include "../include/GeomBatch.h"
+#include "../include/GeomAnnealer.h"
+#include "../include/GeomSceneIO.h"
+#include <omp.h>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+namespace simugeom
+{
+
+int GeomBatchWriterSink::consume(const GeomScene& gs, const GeomBatchJob& job)
+{
+    GeomSceneWriter gsw(gs);
+    return gsw.write((prefix+std::to_string(job.index)+".gscn").c_str());
+}
+
+GeomBatch::GeomBatch(const GeomScene& _templ) : templ(_templ), num_threads(0),
+    num_proposals(1), maxiters(500), seconds(0.0)
+{
+}
+
+GeomBatch::~GeomBatch()
+{
+}
+
+void GeomBatch::solve_job(GeomBatchJob& job, const int32_t worker, GeomBatchSink& sink)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    GeomScene gs(templ);
+    gs.set_seed(job.seed);
+    GeomAnnealer gan(gs);
+    gan.set_num_proposals(num_proposals);
+    gan.set_maxiters(maxiters);
+    gan.set_stop_criteria(stop);
+    job.stop_reason = gan.solve();
+    job.num_iters = gan.get_curr_iter();
+    job.cost = gan.get_cost_best();
+    job.worker = worker;
+    job.status = sink.consume(gs, job);
+    job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+}
+
+int GeomBatch::run(const int64_t count, const uint32_t seed_begin, GeomBatchSink& sink)
+{
+    // the jobs are dealt out in contiguous runs, a worker takes from the
+    // back of its own deque and steals from the front of another's
+    const int32_t nthreads = (num_threads>0)?num_threads:std::max(1u, std::thread::hardware_concurrency());
+    jobs.assign(std::max<int64_t>(count, 0), GeomBatchJob());
+    struct WorkQueue
+    {
+        std::mutex mtx;
+        std::deque<int64_t> items;
+    };
+    std::vector<WorkQueue> queues(nthreads);
+    for(int64_t i=0; i<int64_t(jobs.size()); ++i)
+    {
+        jobs[i].index = i;
+        jobs[i].seed = seed_begin+uint32_t(i);
+        jobs[i].status = -1;
+        queues[(i*nthreads)/jobs.size()].items.push_back(i);
+    }
+    std::atomic<int64_t> num_left(jobs.size());
+    auto work = [&](const int32_t w)
+    {
+        // each worker already runs one scene per core, keep the cost
+        // loops inside it serial
+        omp_set_num_threads(1);
+        uint32_t victim = w;
+        while(num_left.load(std::memory_order_acquire)>0)
+        {
+            int64_t i = -1;
+            {
+                std::lock_guard<std::mutex> lock(queues[w].mtx);
+                if(!queues[w].items.empty())
+                {
+                    i = queues[w].items.back();
+                    queues[w].items.pop_back();
+                }
+            }
+            for(int32_t k=1; i<0 && k<nthreads; ++k)
+            {
+                victim = (victim+1)%nthreads;
+                if(int32_t(victim)==w) continue;
+                std::lock_guard<std::mutex> lock(queues[victim].mtx);
+                if(!queues[victim].items.empty())
+                {
+                    i = queues[victim].items.front();
+                    queues[victim].items.pop_front();
+                }
+            }
+            if(i<0) break;
+            solve_job(jobs[i], w, sink);
+            num_left.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+    const int omp_threads = omp_get_max_threads();
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(int32_t w=1; w<nthreads; ++w) workers.emplace_back(work, w);
+    work(0);
+    for(auto& t : workers) t.join();
+    omp_set_num_threads(omp_threads);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+    int status = 0;
+    for(const auto& job : jobs)
+    {
+        if(job.status!=0) status = -1;
+    }
+    return status;
+}
+
+int GeomBatch::export_timing(const char* fname) const
+{
+    std::ofstream ofs(fname);
+    if(!ofs.is_open()) return -1;
+    for(const auto& job : jobs)
+    {
+        ofs<<job.index<<" "<<job.seed<<" "<<job.worker<<" "<<job.seconds<<" "<<job.cost<<" "<<job.status<<" "
+           <<job.num_iters<<" "<<int(job.stop_reason)<<"\n";
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,129 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomCheckpoint.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomCheckpoint.
+ */
+
+#include "../include/GeomCheckpoint.h"
+#include <fstream>
+#include <cstdio>
+
+namespace simugeom
+{
+
+GeomCheckpointWriter::GeomCheckpointWriter() : is_open(false), has_pending(false), is_busy(false),
+    is_stopping(false), status(0), num_written(0)
+{
+}
+
+GeomCheckpointWriter::~GeomCheckpointWriter()
+{
+    close();
+}
+
+int GeomCheckpointWriter::open(const char* _fname)
+{
+    close();
+    fname = _fname;
+    has_pending = false;
+    is_busy = false;
+    is_stopping = false;
+    status = 0;
+    num_written = 0;
+    is_open = true;
+    worker = std::thread(&GeomCheckpointWriter::run, this);
+    return 0;
+}
+
+void GeomCheckpointWriter::post(std::vector<char>& buf)
+{
+    if(!is_open) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.swap(buf);
+        has_pending = true;
+    }
+    cv.notify_all();
+}
+
+int GeomCheckpointWriter::flush()
+{
+    if(!is_open) return -1;
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this]() { return !has_pending && !is_busy; });
+    return status;
+}
+
+int GeomCheckpointWriter::close()
+{
+    if(!is_open) return 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        is_stopping = true;
+    }
+    cv.notify_all();
+    if(worker.joinable()) worker.join();
+    is_open = false;
+    return status;
+}
+
+int GeomCheckpointWriter::write_file(const char* fname, const std::vector<char>& buf)
+{
+    const std::string tname = std::string(fname)+".tmp";
+    {
+        std::ofstream ofs(tname, std::ios::binary|std::ios::trunc);
+        if(!ofs.is_open()) return -1;
+        ofs.write(buf.data(), buf.size());
+        ofs.flush();
+        if(!ofs.good()) return -1;
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file here
+    std::remove(fname);
+#endif
+    return (std::rename(tname.c_str(), fname)==0)?0:-1;
+}
+
+void GeomCheckpointWriter::run()
+{
+    // the pending buffer is written on exit too, so closing loses nothing
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true)
+    {
+        cv.wait(lock, [this]() { return has_pending || is_stopping; });
+        if(!has_pending) break;
+        current.swap(pending);
+        has_pending = false;
+        is_busy = true;
+        lock.unlock();
+        const int res = write_file(fname.c_str(), current);
+        lock.lock();
+        is_busy = false;
+        status = res;
+        if(res==0) ++num_written;
+        cv.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomChecksum.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomChecksum.
+ */
+
+#include "../include/GeomChecksum.h"
+
+namespace simugeom
+{
+
+static const uint32_t (*get_crc32_table())[256]
+{
+    // slicing-by-8 tables, table[k] advances a byte through k more zeros
+    static uint32_t table[8][256];
+    static const bool is_built = [](){
+        for(uint32_t i=0; i<256; ++i)
+        {
+            uint32_t c = i;
+            for(int k=0; k<8; ++k) c = (c&1)?(0xEDB88320u^(c>>1)):(c>>1);
+            table[0][i] = c;
+        }
+        for(uint32_t i=0; i<256; ++i)
+        {
+            for(int k=1; k<8; ++k) table[k][i] = table[0][table[k-1][i]&0xFF]^(table[k-1][i]>>8);
+        }
+        return true;
+    }();
+    (void)is_built;
+    return table;
+}
+
+uint32_t get_crc32(const void* data, const std::size_t n, const uint32_t crc)
+{
+    const uint32_t (*table)[256] = get_crc32_table();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p+n;
+    uint32_t c = ~crc;
+    // eight bytes per step, assembled bytewise so that it is endian neutral
+    for(; (end-p)>=8; p+=8)
+    {
+        c ^= uint32_t(p[0])|(uint32_t(p[1])<<8)|(uint32_t(p[2])<<16)|(uint32_t(p[3])<<24);
+        c = table[7][c&0xFF]^table[6][(c>>8)&0xFF]^table[5][(c>>16)&0xFF]^table[4][c>>24]
+            ^table[3][p[4]]^table[2][p[5]]^table[1][p[6]]^table[0][p[7]];
+    }
+    for(; p<end; ++p) c = table[0][(c^*p)&0xFF]^(c>>8);
+    return ~c;
+}
+
+}
@@ -0,0 +1,195 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomKernels.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomKernels.
+ */
+
+#include "../include/GeomKernels.h"
+
+// runtime dispatch needs gcc/clang on x86; mingw gcc does not align
+// the stack for spilled avx registers, so it keeps the scalar path
+#if !defined(SIMUGEOM_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__)) \
+    && !(defined(_WIN32) && !defined(__clang__))
+#define SIMUGEOM_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace simugeom
+{
+
+typedef void (*bb_radius_batch_fn)(const ObjClass::GeomType, const double, const double,
+                                   const double, const double, const double, const double,
+                                   const double*, const double*, double*, const int32_t);
+
+static void get_bb_radius_batch_scalar(const ObjClass::GeomType type, const double rx, const double ry,
+                                       const double px, const double py, const double cr, const double sr,
+                                       const double* x, const double* y, double* out, const int32_t n)
+{
+    for(int32_t i=0; i<n; ++i)
+    {
+        out[i] = get_bb_radius_kernel(type, rx, ry, px, py, cr, sr, x[i], y[i]);
+    }
+}
+
+#ifdef SIMUGEOM_X86_DISPATCH
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+static void get_bb_radius_batch_avx2(const ObjClass::GeomType type, const double rx, const double ry,
+                                     const double px, const double py, const double cr, const double sr,
+                                     const double* x, const double* y, double* out, const int32_t n)
+{
+    const __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py);
+    const __m256d vcr = _mm256_set1_pd(cr), vsr = _mm256_set1_pd(sr), vnsr = _mm256_set1_pd(-sr);
+    const __m256d vrx = _mm256_set1_pd(rx), vry = _mm256_set1_pd(ry);
+    const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+    const __m256d signbit = _mm256_set1_pd(-0.0);
+    const bool is_cuboid = (type==ObjClass::GeomType::Cuboid);
+    int32_t i = 0;
+    for(; i+4<=n; i+=4)
+    {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x+i), vpx);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y+i), vpy);
+        const __m256d rho2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        const __m256d centre = _mm256_cmp_pd(rho2, zero, _CMP_EQ_OQ);
+        __m256d u = _mm256_add_pd(_mm256_mul_pd(vcr, dx), _mm256_mul_pd(vsr, dy));
+        __m256d v = _mm256_sub_pd(_mm256_mul_pd(vcr, dy), _mm256_mul_pd(vsr, dx));
+        __m256d rho = _mm256_sqrt_pd(rho2);
+        u = _mm256_blendv_pd(u, vcr, centre);
+        v = _mm256_blendv_pd(v, vnsr, centre);
+        rho = _mm256_blendv_pd(rho, one, centre);
+        __m256d r;
+        if(is_cuboid)
+        {
+            const __m256d a = _mm256_div_pd(vrx, _mm256_andnot_pd(signbit, u));
+            const __m256d b = _mm256_div_pd(vry, _mm256_andnot_pd(signbit, v));
+            // same operand order as std::min(a, b)
+            r = _mm256_mul_pd(rho, _mm256_blendv_pd(a, b, _mm256_cmp_pd(b, a, _CMP_LT_OQ)));
+        }
+        else
+        {
+            const __m256d tu = _mm256_mul_pd(vrx, u);
+            const __m256d tv = _mm256_mul_pd(vry, v);
+            r = _mm256_div_pd(_mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(tu, tu), _mm256_mul_pd(tv, tv))), rho);
+        }
+        _mm256_storeu_pd(out+i, r);
+    }
+    get_bb_radius_batch_scalar(type, rx, ry, px, py, cr, sr, x+i, y+i, out+i, n-i);
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static void get_bb_radius_batch_avx512(const ObjClass::GeomType type, const double rx, const double ry,
+                                       const double px, const double py, const double cr, const double sr,
+                                       const double* x, const double* y, double* out, const int32_t n)
+{
+    const __m512d vpx = _mm512_set1_pd(px), vpy = _mm512_set1_pd(py);
+    const __m512d vcr = _mm512_set1_pd(cr), vsr = _mm512_set1_pd(sr), vnsr = _mm512_set1_pd(-sr);
+    const __m512d vrx = _mm512_set1_pd(rx), vry = _mm512_set1_pd(ry);
+    const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0);
+    const __mmask8 all = 0xff;
+    const bool is_cuboid = (type==ObjClass::GeomType::Cuboid);
+    int32_t i = 0;
+    for(; i+8<=n; i+=8)
+    {
+        const __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x+i), vpx);
+        const __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y+i), vpy);
+        const __m512d rho2 = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+        const __mmask8 centre = _mm512_cmp_pd_mask(rho2, zero, _CMP_EQ_OQ);
+        __m512d u = _mm512_add_pd(_mm512_mul_pd(vcr, dx), _mm512_mul_pd(vsr, dy));
+        __m512d v = _mm512_sub_pd(_mm512_mul_pd(vcr, dy), _mm512_mul_pd(vsr, dx));
+        __m512d rho = _mm512_maskz_sqrt_pd(all, rho2);
+        u = _mm512_mask_blend_pd(centre, u, vcr);
+        v = _mm512_mask_blend_pd(centre, v, vnsr);
+        rho = _mm512_mask_blend_pd(centre, rho, one);
+        __m512d r;
+        if(is_cuboid)
+        {
+            const __m512d a = _mm512_div_pd(vrx, _mm512_abs_pd(u));
+            const __m512d b = _mm512_div_pd(vry, _mm512_abs_pd(v));
+            r = _mm512_mul_pd(rho, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(b, a, _CMP_LT_OQ), a, b));
+        }
+        else
+        {
+            const __m512d tu = _mm512_mul_pd(vrx, u);
+            const __m512d tv = _mm512_mul_pd(vry, v);
+            r = _mm512_div_pd(_mm512_maskz_sqrt_pd(all, _mm512_add_pd(_mm512_mul_pd(tu, tu), _mm512_mul_pd(tv, tv))), rho);
+        }
+        _mm512_storeu_pd(out+i, r);
+    }
+    get_bb_radius_batch_scalar(type, rx, ry, px, py, cr, sr, x+i, y+i, out+i, n-i);
+}
+
+#endif
+
+static bb_radius_batch_fn select_bb_radius_batch(const char** isa)
+{
+#ifdef SIMUGEOM_X86_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+    {
+        *isa = "avx512f";
+        return get_bb_radius_batch_avx512;
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        *isa = "avx2";
+        return get_bb_radius_batch_avx2;
+    }
+#endif
+    *isa = "scalar";
+    return get_bb_radius_batch_scalar;
+}
+
+static const char* kernel_isa = nullptr;
+
+void get_bb_radius_batch(const ObjClass::GeomType type, const double rx, const double ry,
+                         const double px, const double py, const double cr, const double sr,
+                         const double* x, const double* y, double* out, const int32_t n)
+{
+    static const bb_radius_batch_fn impl = select_bb_radius_batch(&kernel_isa);
+    impl(type, rx, ry, px, py, cr, sr, x, y, out, n);
+}
+
+void get_bb_radius_profile(const ObjClass::GeomType type, const double rx, const double ry, double* prof)
+{
+    for(int32_t k=0; k<=bb_profile_size; ++k)
+    {
+        // direction on the unit diamond u+v = 1 for t = k/size
+        const double t = double(k)/bb_profile_size;
+        prof[k] = get_bb_radius_kernel(type, rx, ry, 0.0, 0.0, 1.0, 0.0, 1.0-t, t);
+    }
+}
+
+const char* get_kernel_isa()
+{
+    if(kernel_isa==nullptr)
+    {
+        double r;
+        const double p = 1.0;
+        get_bb_radius_batch(ObjClass::GeomType::Cuboid, 1.0, 1.0, 0.0, 0.0, 1.0, 0.0, &p, &p, &r, 1);
+    }
+    return kernel_isa;
+}
+
+}
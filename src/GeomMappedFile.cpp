@@ -0,0 +1,128 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomMappedFile.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomMappedFile.
+ */
+
+#include "../include/GeomMappedFile.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace simugeom
+{
+
+GeomMappedFile::GeomMappedFile() : data(nullptr), size(0), is_open(false)
+#if defined(_WIN32)
+    , hfile(nullptr), hmap(nullptr)
+#endif
+{
+}
+
+GeomMappedFile::~GeomMappedFile()
+{
+    close();
+}
+
+int GeomMappedFile::open(const char* fname)
+{
+    close();
+#if defined(_WIN32)
+    HANDLE hf = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(hf==INVALID_HANDLE_VALUE) return -1;
+    LARGE_INTEGER sz;
+    if(!GetFileSizeEx(hf, &sz))
+    {
+        CloseHandle(hf);
+        return -1;
+    }
+    hfile = hf;
+    size = sz.QuadPart;
+    if(size>0)
+    {
+        HANDLE hm = CreateFileMappingA(hf, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(hm==NULL)
+        {
+            CloseHandle(hf);
+            hfile = nullptr;
+            return -1;
+        }
+        hmap = hm;
+        data = static_cast<const char*>(MapViewOfFile(hm, FILE_MAP_READ, 0, 0, 0));
+        if(data==nullptr)
+        {
+            close();
+            return -1;
+        }
+    }
+#else
+    const int fd = ::open(fname, O_RDONLY);
+    if(fd<0) return -1;
+    struct stat st;
+    if(fstat(fd, &st)!=0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    size = st.st_size;
+    if(size>0)
+    {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p==MAP_FAILED)
+        {
+            ::close(fd);
+            size = 0;
+            return -1;
+        }
+        data = static_cast<const char*>(p);
+    }
+    // the mapping outlives the descriptor
+    ::close(fd);
+#endif
+    is_open = true;
+    return 0;
+}
+
+void GeomMappedFile::close()
+{
+#if defined(_WIN32)
+    if(data) UnmapViewOfFile(data);
+    if(hmap) CloseHandle(static_cast<HANDLE>(hmap));
+    if(hfile) CloseHandle(static_cast<HANDLE>(hfile));
+    hmap = nullptr;
+    hfile = nullptr;
+#else
+    if(data) munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    is_open = false;
+}
+
+}
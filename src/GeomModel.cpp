@@ -27,6 +27,7 @@
 
 #include "../include/GeomModel.h"
 #include "../include/GeomScene.h"
+#include "../include/GeomKernels.h"
 
 #include <meshlib.h>
 #include <cmath>
@@ -59,50 +60,27 @@ GeomModel::~GeomModel()
 
 double GeomModel::get_bb_radius_from(const double x, const double y) const
 {
-    double bbrad = std::max(radius(0,0), radius(1,0));
-    double reltheta = std::atan2((y-pose.pos(1,0)), (x-pose.pos(0,0)))-pose.rot;
-    if(reltheta>=MESH_PI) reltheta -= MESH_TWOPI;
-    else if(reltheta<=-MESH_PI) reltheta += MESH_TWOPI;
+    return get_bb_radius_kernel(type, radius(0,0), radius(1,0), pose.pos(0,0), pose.pos(1,0),
+                                std::cos(pose.rot), std::sin(pose.rot), x, y);
+}
 
-    switch(type)
-    {
-    case ObjClass::GeomType::Cuboid:
-    {
-        const double phi = std::atan2(radius(1,0), radius(0,0));
-        // phi = [-180 to 180 deg] in radian
-        // based on side of rectangle
-        if(std::abs(reltheta)<=std::abs(phi))
-        {
-            // right side
-            bbrad = radius(0,0)/std::cos(reltheta);
-        }
-        else if(std::abs(reltheta)>=(MESH_PI-std::abs(phi)))
-        {
-            // left side
-            bbrad = -radius(0,0)/std::cos(reltheta);
-        }
-        else if(reltheta>=phi && reltheta<=(MESH_PI-phi))
-        {
-            // top side
-            bbrad = radius(1,0)/std::sin(reltheta);
-        }
-        else
-        {
-            // bottom side
-            bbrad = -radius(1,0)/std::sin(reltheta);
-        }
-    }
-    break;
+void GeomModel::get_bb_radius_from(const double* x, const double* y, double* out, const int32_t n) const
+{
+    get_bb_radius_batch(type, radius(0,0), radius(1,0), pose.pos(0,0), pose.pos(1,0),
+                        std::cos(pose.rot), std::sin(pose.rot), x, y, out, n);
+}
 
-    case ObjClass::GeomType::Ellipsoid:
-    {
-        const auto tmp1 = radius(0,0)*std::cos(-reltheta);
-        const auto tmp2 = radius(1,0)*std::sin(-reltheta);
-        bbrad = std::sqrt(tmp1*tmp1+tmp2*tmp2);
-    }
-    break;
-    }
-    return bbrad;
+double GeomModel::get_bb_radius_from_profile(const double x, const double y) const
+{
+    if(bb_profile.empty()) return get_bb_radius_from(x, y);
+    return get_bb_radius_lookup(bb_profile.data(), pose.pos(0,0), pose.pos(1,0),
+                                std::cos(pose.rot), std::sin(pose.rot), x, y);
+}
+
+void GeomModel::build_bb_radius_profile()
+{
+    bb_profile.resize(bb_profile_size+1);
+    simugeom::get_bb_radius_profile(type, radius(0,0), radius(1,0), bb_profile.data());
 }
 
 double GeomModel::get_bb_radius_from(const Eigen::Vector2d xy) const
@@ -117,20 +95,25 @@ double GeomModel::get_bb_radius_from(const Eigen::Vector3d xyz) const
 } */
 
 void GeomModel::propose_perturb(const int n, const double sigmpos,
-                                const double sigmrot, GeomScene& gsn)
+                                const double sigmrot, GeomScene& gsn, const uint32_t iter, const uint32_t k0)
 {
+    const bool is_counter = (gsn.rng_mode==GeomScene::RngMode::Counter);
     proposed_poses.resize(n);
     for(int i=0; i<n; ++i)
     {
         GeomPose& cpose = proposed_poses[i];
+        GeomPhiloxStream stream(gsn.philox, GeomRngDomain::Perturb, oid, iter, k0+i);
+        auto get_uniform = [&]() {
+            return is_counter?stream.get_uniform():gsn.unidist(gsn.rng);
+        };
         while(true)
         {
             Eigen::Vector3d delpos;
-            delpos(0,0) = sigmpos*gsn.unidist(gsn.rng);
-            delpos(1,0) = sigmpos*gsn.unidist(gsn.rng);
+            delpos(0,0) = sigmpos*get_uniform();
+            delpos(1,0) = sigmpos*get_uniform();
             delpos(2,0) = 0.0;
             cpose.pos = pose.pos+delpos;
-            double delrot = sigmrot*gsn.unidist(gsn.rng);
+            double delrot = sigmrot*get_uniform();
             cpose.rot = pose.rot+delrot;
             if(gsn.boundary.is_inside(cpose.pos(0,0), cpose.pos(1,0)))
                 break;
@@ -0,0 +1,79 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomPairCache.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomPairCache.
+ */
+
+#include "../include/GeomPairCache.h"
+
+namespace simugeom
+{
+
+GeomPairCache::GeomPairCache()
+    : scratch_wall(0.0), scratch_x(0.0), scratch_y(0.0), scratch_rot(0.0), scratch_oid(-1), proposed_oid(-1)
+{
+}
+
+GeomPairCache::~GeomPairCache()
+{
+}
+
+void GeomPairCache::resize(const int32_t n)
+{
+    cost.assign(std::size_t(n)*n, 0.0);
+    proposed.clear();
+    wall.assign(n, 0.0);
+    scratch.assign(n, 0.0);
+    x.resize(n);
+    y.resize(n);
+    rot.resize(n);
+    rx.resize(n);
+    ry.resize(n);
+    clear();
+}
+
+void GeomPairCache::clear()
+{
+    valid.assign(x.size(), 0);
+    scratch_oid = -1;
+    proposed_oid = -1;
+}
+
+bool GeomPairCache::get_is_current(const GeomSceneSoA& soa, const int i) const
+{
+    return valid[i] && x[i]==soa.x[i] && y[i]==soa.y[i] && rot[i]==soa.rot[i]
+            && rx[i]==soa.rx[i] && ry[i]==soa.ry[i];
+}
+
+void GeomPairCache::set_current(const GeomSceneSoA& soa, const int i)
+{
+    x[i] = soa.x[i];
+    y[i] = soa.y[i];
+    rot[i] = soa.rot[i];
+    rx[i] = soa.rx[i];
+    ry[i] = soa.ry[i];
+    valid[i] = 1;
+}
+
+}
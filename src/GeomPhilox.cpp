@@ -0,0 +1,94 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomPhilox.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomPhilox.
+ */
+
+#include "../include/GeomPhilox.h"
+
+namespace simugeom
+{
+
+static inline void mul_hi_lo(const uint32_t a, const uint32_t b, uint32_t& hi, uint32_t& lo)
+{
+    const uint64_t p = uint64_t(a)*b;
+    hi = uint32_t(p>>32);
+    lo = uint32_t(p);
+}
+
+void GeomPhilox::get_block(const GeomRngDomain domain, const uint32_t ctr[4], uint32_t out[4]) const
+{
+    // multipliers and weyl key increments of random123
+    const uint32_t m0 = 0xD2511F53u, m1 = 0xCD9E8D57u;
+    const uint32_t w0 = 0x9E3779B9u, w1 = 0xBB67AE85u;
+    uint32_t k0 = seed, k1 = uint32_t(domain);
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    for(int r=0; r<10; ++r)
+    {
+        uint32_t hi0, lo0, hi1, lo1;
+        mul_hi_lo(m0, c0, hi0, lo0);
+        mul_hi_lo(m1, c2, hi1, lo1);
+        c0 = hi1^c1^k0;
+        c1 = lo1;
+        c2 = hi0^c3^k1;
+        c3 = lo0;
+        k0 += w0;
+        k1 += w1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+static inline double get_symmetric_uniform(const uint32_t x)
+{
+    // (-1, 1) with 32 bits, never hitting either end
+    return (double(int32_t(x))+0.5)*(1.0/2147483648.0);
+}
+
+void GeomPhiloxStream::refill()
+{
+    uint32_t out[4];
+    gen.get_block(domain, ctr, out);
+    ++ctr[0];
+    for(int i=0; i<4; ++i) buf[i] = get_symmetric_uniform(out[i]);
+    num_left = 4;
+}
+
+void GeomPhiloxStream::get_uniforms(double* out, const std::size_t n)
+{
+    std::size_t i = 0;
+    for(; i<n && num_left>0; ++i) out[i] = get_uniform();
+    uint32_t blk[4];
+    for(; i+4<=n; i+=4)
+    {
+        gen.get_block(domain, ctr, blk);
+        ++ctr[0];
+        for(int j=0; j<4; ++j) out[i+j] = get_symmetric_uniform(blk[j]);
+    }
+    for(; i<n; ++i) out[i] = get_uniform();
+}
+
+}
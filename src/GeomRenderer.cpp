@@ -27,9 +27,19 @@
 
 #include "../include/GeomRenderer.h"
 #include "../include/GeomScene.h"
+#include "../include/GeomChecksum.h"
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#ifndef SIMUGEOM_NO_SDL
 #include <SDL2/SDL2_gfxPrimitives.h>
+#endif
+#if defined(_WIN32) || defined(__WIN32__) ||defined(WIN32) || defined(WINNT)
 #include <windows.h>
+#endif
 
 
 namespace simugeom
@@ -45,6 +55,7 @@ std::array<Colour::components,10> pallete =
     Colour::BlueViolet
 };
 
+#ifndef SIMUGEOM_NO_SDL
 static void set_icon(SDL_Window* w)
 {
 #if defined(_WIN32) || defined(__WIN32__) ||defined(WIN32) || defined(WINNT)
@@ -82,14 +93,122 @@ static void set_icon(SDL_Window* w)
     }
 #endif
 }
+#endif
+
+// 3x5 glyphs of the characters used in the labels, one row per entry
+// with the leftmost pixel in bit 2
+static const uint8_t* get_glyph(const char c)
+{
+    static const uint8_t digits[10][5] =
+    {
+        {7,5,5,5,7}, {2,6,2,2,7}, {7,1,7,4,7}, {7,1,7,1,7}, {5,5,7,1,1},
+        {7,4,7,1,7}, {7,4,7,5,7}, {7,1,1,1,1}, {7,5,7,5,7}, {7,5,7,1,7}
+    };
+    static const uint8_t slash[5] = {1,1,2,4,4};
+    static const uint8_t minus[5] = {0,0,7,0,0};
+    if(c>='0' && c<='9') return digits[c-'0'];
+    if(c=='/') return slash;
+    if(c=='-') return minus;
+    return nullptr;
+}
+
+static void put_be32(std::vector<uint8_t>& out, const uint32_t v)
+{
+    out.push_back(v>>24);
+    out.push_back(v>>16);
+    out.push_back(v>>8);
+    out.push_back(v);
+}
+
+static void put_png_chunk(std::ofstream& ofs, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    put_be32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type+4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_be32(chunk, get_crc32(chunk.data()+4, chunk.size()-4));
+    ofs.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+static int write_png(const char* fname, const uint8_t* rgba, const int32_t w, const int32_t h)
+{
+    // uncompressed deflate blocks, the frames are small and this keeps the
+    // writer free of a zlib dependency
+    std::ofstream ofs(fname, std::ios::binary);
+    if(!ofs.is_open()) return -1;
+    static const uint8_t sig[8] = {137,80,78,71,13,10,26,10};
+    ofs.write(reinterpret_cast<const char*>(sig), 8);
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, w);
+    put_be32(ihdr, h);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});
+    put_png_chunk(ofs, "IHDR", ihdr);
+    std::vector<uint8_t> raw;
+    raw.reserve(std::size_t(h)*(1+4*w));
+    for(int32_t y=0; y<h; ++y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgba+std::size_t(y)*4*w, rgba+std::size_t(y+1)*4*w);
+    }
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    const std::size_t n = raw.size();
+    for(std::size_t p=0; p<n; p+=65535)
+    {
+        const uint32_t len = std::min<std::size_t>(65535, n-p);
+        idat.push_back((p+len)==n);
+        idat.push_back(len&0xFF);
+        idat.push_back(len>>8);
+        idat.push_back(~len&0xFF);
+        idat.push_back((~len>>8)&0xFF);
+        idat.insert(idat.end(), raw.begin()+p, raw.begin()+p+len);
+    }
+    uint32_t a = 1, b = 0;
+    for(const uint8_t c : raw)
+    {
+        a = (a+c)%65521;
+        b = (b+a)%65521;
+    }
+    put_be32(idat, (b<<16)|a);
+    put_png_chunk(ofs, "IDAT", idat);
+    put_png_chunk(ofs, "IEND", std::vector<uint8_t>());
+    return ofs.good()?0:-1;
+}
+
+static int write_ppm(const char* fname, const uint8_t* rgba, const int32_t w, const int32_t h)
+{
+    std::ofstream ofs(fname, std::ios::binary);
+    if(!ofs.is_open()) return -1;
+    ofs<<"P6\n"<<w<<" "<<h<<"\n255\n";
+    std::vector<uint8_t> rgb(std::size_t(w)*h*3);
+    for(std::size_t i=0, n=std::size_t(w)*h; i<n; ++i)
+    {
+        rgb[3*i] = rgba[4*i];
+        rgb[3*i+1] = rgba[4*i+1];
+        rgb[3*i+2] = rgba[4*i+2];
+    }
+    ofs.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    return ofs.good()?0:-1;
+}
 
-GeomRenderer::GeomRenderer(const GeomScene& _gs) : renderer(nullptr), window(nullptr), gs(_gs), m(nullptr), render_ready(false),
-    thickness(2), rc(0), gc(0), bc(0), curriter(0), maxiters(0)
+GeomRenderer::GeomRenderer(const GeomScene& _gs, const Backend _backend) : renderer(nullptr), window(nullptr), gs(_gs),
+    backend(_backend), width(SCREEN_WIDTH), height(SCREEN_HEIGHT), m(nullptr), render_ready(false),
+    thickness(2), rc(0), gc(0), bc(0), curriter(0), maxiters(0),
+    snap_state(2), snap_back(0), snap_front(1), is_running(false), is_stopping(false)
 {
     scale = 0.35*std::sqrt((SCREEN_WIDTH*SCREEN_WIDTH+SCREEN_HEIGHT*SCREEN_HEIGHT)/(gs.bbox.rad(0,0)*gs.bbox.rad(0,0)+gs.bbox.rad(0,0)*gs.bbox.rad(0,0)));
+#ifdef SIMUGEOM_NO_SDL
+    backend = Backend::Software;
+#endif
+    if(backend==Backend::Software)
+    {
+        pixels.resize(std::size_t(width)*height*4);
+        clear_canvas();
+    }
 }
 GeomRenderer::~GeomRenderer()
 {
+    stop();
+#ifndef SIMUGEOM_NO_SDL
     if(render_ready)
     {
         render_ready = false;
@@ -99,12 +218,17 @@ GeomRenderer::~GeomRenderer()
         renderer = nullptr;
         SDL_Quit();
     }
+#endif
     if(m!=nullptr) mesh_free_mesh(m);
 }
 
 int GeomRenderer::initSDL()
 {
     render_ready = false;
+#ifdef SIMUGEOM_NO_SDL
+    return -1;
+#else
+    if(backend==Backend::Software) return -1;
     int rendererFlags, windowFlags;
     rendererFlags = SDL_RENDERER_ACCELERATED;
     windowFlags = 0;
@@ -137,15 +261,143 @@ int GeomRenderer::initSDL()
     SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
     SDL_RenderClear(renderer);
     return 0;
+#endif
 }
 
 void GeomRenderer::refresh()
 {
+#ifndef SIMUGEOM_NO_SDL
     if(render_ready)
     {
         SDL_Event event;
         SDL_PollEvent(&event);
     }
+#endif
+}
+
+void GeomRenderer::clear_canvas()
+{
+    std::memset(pixels.data(), 0xFF, pixels.size());
+}
+
+static int get_pixel(const double v)
+{
+    // screen coordinate of v, clamped so that far off models neither
+    // overflow the int nor the line arithmetic
+    const double guard = 1<<20;
+    if(!(v>-guard)) return -(1<<20);
+    if(!(v<guard)) return 1<<20;
+    return int(v);
+}
+
+static bool clip_line(int& x0, int& y0, int& x1, int& y1, const int xmin, const int ymin, const int xmax, const int ymax)
+{
+    // liang-barsky clipping of the segment to [xmin,xmax] x [ymin,ymax],
+    // false if it misses the box
+    const double dx = x1-x0;
+    const double dy = y1-y0;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {double(x0-xmin), double(xmax-x0), double(y0-ymin), double(ymax-y0)};
+    double t0 = 0.0, t1 = 1.0;
+    for(int k=0; k<4; ++k)
+    {
+        if(p[k]==0.0)
+        {
+            if(q[k]<0.0) return false;
+            continue;
+        }
+        const double t = q[k]/p[k];
+        if(p[k]<0.0)
+        {
+            if(t>t1) return false;
+            t0 = std::max(t0, t);
+        }
+        else
+        {
+            if(t<t0) return false;
+            t1 = std::min(t1, t);
+        }
+    }
+    const int xs = x0, ys = y0;
+    if(t0>0.0)
+    {
+        x0 = int(std::lround(xs+t0*dx));
+        y0 = int(std::lround(ys+t0*dy));
+    }
+    if(t1<1.0)
+    {
+        x1 = int(std::lround(xs+t1*dx));
+        y1 = int(std::lround(ys+t1*dy));
+    }
+    return true;
+}
+
+void GeomRenderer::raster_line(int x0, int y0, int x1, int y1, const int t)
+{
+    // bresenham with a t x t square pen, clipped to the canvas
+    const int dx = std::abs(x1-x0), sx = (x0<x1)?1:-1;
+    const int dy = -std::abs(y1-y0), sy = (y0<y1)?1:-1;
+    const int o = (t-1)/2;
+    int err = dx+dy;
+    while(true)
+    {
+        for(int py=y0-o; py<y0-o+t; ++py)
+        {
+            if(py<0 || py>=height) continue;
+            for(int px=x0-o; px<x0-o+t; ++px)
+            {
+                if(px<0 || px>=width) continue;
+                uint8_t* p = &pixels[4*(std::size_t(py)*width+px)];
+                p[0] = rc;
+                p[1] = gc;
+                p[2] = bc;
+                p[3] = 255;
+            }
+        }
+        if(x0==x1 && y0==y1) break;
+        const int e2 = 2*err;
+        if(e2>=dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+        if(e2<=dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void GeomRenderer::raster_text(int x, int y, const char* s)
+{
+    for(; *s; ++s, x+=4)
+    {
+        const uint8_t* g = get_glyph(*s);
+        if(!g) continue;
+        for(int r=0; r<5; ++r)
+        {
+            for(int c=0; c<3; ++c)
+            {
+                if(g[r]&(4>>c)) raster_line(x+c, y+r, x+c, y+r, 1);
+            }
+        }
+    }
+}
+
+void GeomRenderer::draw_line(int x0, int y0, int x1, int y1)
+{
+    // only the part within a pen width of the canvas is rasterized
+    const int o = thickness;
+    if(!clip_line(x0, y0, x1, y1, -o, -o, int(width)-1+o, int(height)-1+o)) return;
+    if(backend==Backend::Software)
+    {
+        raster_line(x0, y0, x1, y1, thickness);
+        return;
+    }
+#ifndef SIMUGEOM_NO_SDL
+    thickLineRGBA(renderer, x0, y0, x1, y1, thickness, rc, gc, bc, 255);
+#endif
 }
 
 void GeomRenderer::draw_cuboid(double cx, double cy, double radx, double rady, double angle)
@@ -155,24 +407,24 @@ void GeomRenderer::draw_cuboid(double cx, double cy, double radx, double rady, d
     radx = radx*scale;
     rady = rady*scale;
     double cs = std::cos(angle), sn = std::sin(angle);
-    int x0 = (SCREEN_WIDTH/2)+cx+radx*cs-rady*sn;
-    int y0 = (SCREEN_HEIGHT/2)-(cy-radx*sn-rady*cs);
-    int x1 = (SCREEN_WIDTH/2)+cx+radx*cs+rady*sn;
-    int y1 = (SCREEN_HEIGHT/2)-(cy-radx*sn+rady*cs);
-    int x2 = (SCREEN_WIDTH/2)+cx-radx*cs+rady*sn;
-    int y2 = (SCREEN_HEIGHT/2)-(cy+radx*sn+rady*cs);
-    int x3 = (SCREEN_WIDTH/2)+cx-radx*cs-rady*sn;
-    int y3 = (SCREEN_HEIGHT/2)-(cy+radx*sn-rady*cs);
+    int x0 = get_pixel((SCREEN_WIDTH/2)+cx+radx*cs-rady*sn);
+    int y0 = get_pixel((SCREEN_HEIGHT/2)-(cy-radx*sn-rady*cs));
+    int x1 = get_pixel((SCREEN_WIDTH/2)+cx+radx*cs+rady*sn);
+    int y1 = get_pixel((SCREEN_HEIGHT/2)-(cy-radx*sn+rady*cs));
+    int x2 = get_pixel((SCREEN_WIDTH/2)+cx-radx*cs+rady*sn);
+    int y2 = get_pixel((SCREEN_HEIGHT/2)-(cy+radx*sn+rady*cs));
+    int x3 = get_pixel((SCREEN_WIDTH/2)+cx-radx*cs-rady*sn);
+    int y3 = get_pixel((SCREEN_HEIGHT/2)-(cy+radx*sn-rady*cs));
 
 //    SDL_RenderDrawLine(renderer, x0, y0, x1, y1);
 //    SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
 //    SDL_RenderDrawLine(renderer, x2, y2, x3, y3);
 //    SDL_RenderDrawLine(renderer, x3, y3, x0, y0);
 
-    thickLineRGBA(renderer, x0, y0, x1, y1, thickness, rc, gc, bc, 255);
-    thickLineRGBA(renderer, x1, y1, x2, y2, thickness, rc, gc, bc, 255);
-    thickLineRGBA(renderer, x2, y2, x3, y3, thickness, rc, gc, bc, 255);
-    thickLineRGBA(renderer, x3, y3, x0, y0, thickness, rc, gc, bc, 255);
+    draw_line(x0, y0, x1, y1);
+    draw_line(x1, y1, x2, y2);
+    draw_line(x2, y2, x3, y3);
+    draw_line(x3, y3, x0, y0);
 }
 
 void GeomRenderer::draw_ellipsoid(double cx, double cy, double radx, double rady, double angle)
@@ -183,16 +435,16 @@ void GeomRenderer::draw_ellipsoid(double cx, double cy, double radx, double rady
     rady = rady*scale;
     double cs = std::cos(angle), sn = std::sin(angle);
     int x0, x1, y0, y1;
-    x0 = (SCREEN_WIDTH/2)+cx+std::cos(0)*radx*cs+std::sin(0)*rady*sn;
-    y0 = (SCREEN_HEIGHT/2)-(cy-std::cos(0)*radx*sn+std::sin(0)*rady*cs);
+    x0 = get_pixel((SCREEN_WIDTH/2)+cx+std::cos(0)*radx*cs+std::sin(0)*rady*sn);
+    y0 = get_pixel((SCREEN_HEIGHT/2)-(cy-std::cos(0)*radx*sn+std::sin(0)*rady*cs));
 
     for(int32_t i=0; i<12; ++i)
     {
         double th = ((double)(i+1)*MESH_TWOPI)/(12.0);
-        x1 = (SCREEN_WIDTH/2)+cx+std::cos(th)*radx*cs+std::sin(th)*rady*sn;
-        y1 = (SCREEN_HEIGHT/2)-(cy-std::cos(th)*radx*sn+std::sin(th)*rady*cs);
+        x1 = get_pixel((SCREEN_WIDTH/2)+cx+std::cos(th)*radx*cs+std::sin(th)*rady*sn);
+        y1 = get_pixel((SCREEN_HEIGHT/2)-(cy-std::cos(th)*radx*sn+std::sin(th)*rady*cs));
         // SDL_RenderDrawLine(renderer, x0, y0, x1, y1);
-        thickLineRGBA(renderer, x0, y0, x1, y1, thickness, rc, gc, bc, 255);
+        draw_line(x0, y0, x1, y1);
         x0 = x1;
         y0 = y1;
     }
@@ -200,10 +452,20 @@ void GeomRenderer::draw_ellipsoid(double cx, double cy, double radx, double rady
 
 void GeomRenderer::draw_axes()
 {
+    if(backend==Backend::Software)
+    {
+        set_colour(0xAA, 0x0, 0x0);
+        raster_line((SCREEN_WIDTH/2), (SCREEN_HEIGHT/2), (SCREEN_WIDTH/2)+scale, (SCREEN_HEIGHT/2), 1);
+        set_colour(0x0, 0xAA, 0x0);
+        raster_line((SCREEN_WIDTH/2), (SCREEN_HEIGHT/2), (SCREEN_WIDTH/2), (SCREEN_HEIGHT/2)-scale, 1);
+        return;
+    }
+#ifndef SIMUGEOM_NO_SDL
     SDL_SetRenderDrawColor(renderer, 0xAA, 0x0, 0x0, 0xFF);
     SDL_RenderDrawLine(renderer, (SCREEN_WIDTH/2), (SCREEN_HEIGHT/2), (SCREEN_WIDTH/2)+scale, (SCREEN_HEIGHT/2));
     SDL_SetRenderDrawColor(renderer, 0x0, 0xAA, 0x0, 0xFF);
     SDL_RenderDrawLine(renderer, (SCREEN_WIDTH/2), (SCREEN_HEIGHT/2), (SCREEN_WIDTH/2), (SCREEN_HEIGHT/2)-scale);
+#endif
 }
 
 void GeomRenderer::set_iteration(const int32_t _curriter, const int32_t _maxiters)
@@ -218,11 +480,65 @@ void GeomRenderer::draw_text(double cx, double cy, const char* s)
     cy = cy*scale;
     const int x = (SCREEN_WIDTH/2)+cx-3;
     const int y = (SCREEN_HEIGHT/2)-cy-3;
+    if(backend==Backend::Software)
+    {
+        raster_text(x, y, s);
+        return;
+    }
+#ifndef SIMUGEOM_NO_SDL
     stringRGBA(renderer, x, y, s, rc, gc, bc, 255);
+#endif
+}
+
+void GeomRenderer::draw_models(const std::vector<GeomPose>* poses)
+{
+    // draws the models at the given poses, or at their own when null
+    const auto& gsmodels = gs.get_models();
+    int32_t num_models = gsmodels.size();
+    if(poses && int32_t(poses->size())<num_models) num_models = poses->size();
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        const GeomModel& tmodel = gsmodels[i];
+        const GeomPose& tpose = poses?(*poses)[i]:tmodel.get_pose();
+        const auto& rad = tmodel.get_radius();
+        int colnum = tmodel.get_class_id()%pallete.size();
+        Colour ccol{pallete[colnum]};
+        // SDL_SetRenderDrawColor(renderer, ccol.rgb[0]*255, ccol.rgb[1]*255, ccol.rgb[2]*255, 0xFF);
+        set_colour(ccol.rgb[0]*255, ccol.rgb[1]*255, ccol.rgb[2]*255);
+        mesh_vector3 pos0;
+        pos0 = {tpose.pos(0,0), tpose.pos(1,0), tpose.pos(2,0)};
+        switch(gs.get_class(tmodel.get_class_id()).type)
+        {
+        case ObjClass::GeomType::Cuboid:
+            draw_cuboid(pos0.x, pos0.y, rad(0,0), rad(1,0), tpose.rot);
+            break;
+        case ObjClass::GeomType::Ellipsoid:
+            draw_ellipsoid(pos0.x, pos0.y, rad(0,0), rad(1,0), tpose.rot);
+            break;
+        }
+        char str[128];
+        sprintf(str, "%d", i);
+        draw_text(pos0.x, pos0.y, str);
+    }
+    if(maxiters>0)
+    {
+        char str[128];
+        sprintf(str, "%6d/%6d", curriter, maxiters);
+        draw_text(1.2*(gs.bbox.pos(0,0)-gs.bbox.rad(0,0)), 1.2*(gs.bbox.pos(1,0)+gs.bbox.rad(1,0)), str);
+    }
 }
 
 void GeomRenderer::render(bool clear)
 {
+    if(backend==Backend::Software)
+    {
+        // offscreen frame, nothing to present
+        if(clear) clear_canvas();
+        draw_axes();
+        draw_models(nullptr);
+        return;
+    }
+#ifndef SIMUGEOM_NO_SDL
     if(render_ready)
     {
         if(clear)
@@ -232,40 +548,98 @@ void GeomRenderer::render(bool clear)
         }
         draw_axes();
         //SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
-        const auto& gsmodels = gs.get_models();
-        int32_t num_models = gsmodels.size();
-        for(int32_t i=0; i<num_models; ++i)
-        {
-            const GeomModel& tmodel = gsmodels[i];
-            const auto& rad = tmodel.get_radius();
-            int colnum = tmodel.get_class_id()%pallete.size();
-            Colour ccol{pallete[colnum]};
-            // SDL_SetRenderDrawColor(renderer, ccol.rgb[0]*255, ccol.rgb[1]*255, ccol.rgb[2]*255, 0xFF);
-            set_colour(ccol.rgb[0]*255, ccol.rgb[1]*255, ccol.rgb[2]*255);
-            mesh_vector3 pos0;
-            pos0 = {tmodel.get_pose().pos(0,0), tmodel.get_pose().pos(1,0), tmodel.get_pose().pos(2,0)};
-            switch(gs.get_class(tmodel.get_class_id()).type)
-            {
-            case ObjClass::GeomType::Cuboid:
-                draw_cuboid(pos0.x, pos0.y, rad(0,0), rad(1,0), tmodel.get_pose().rot);
-                break;
-            case ObjClass::GeomType::Ellipsoid:
-                draw_ellipsoid(pos0.x, pos0.y, rad(0,0), rad(1,0), tmodel.get_pose().rot);
-                break;
-            }
-            char str[128];
-            sprintf(str, "%d", i);
-            draw_text(pos0.x, pos0.y, str);
-        }
-        if(maxiters>0)
+        draw_models(nullptr);
+        SDL_RenderPresent(renderer);
+        refresh();
+    }
+#endif
+}
+
+int GeomRenderer::start(const double fps)
+{
+    // moves the window to its own thread, which draws the latest published
+    // snapshot at most fps times a second
+    if(is_running.load(std::memory_order_acquire)) return 0;
+    if(backend==Backend::Software || render_ready || fps<=0.0) return -1;
+    const int32_t num_models = gs.get_models().size();
+    for(auto& snap : snaps)
+    {
+        snap.poses.resize(num_models);
+        snap.curriter = 0;
+        snap.maxiters = 0;
+        snap.thickness = thickness;
+    }
+    snap_state.store(2, std::memory_order_relaxed);
+    snap_back = 0;
+    snap_front = 1;
+    is_stopping.store(false, std::memory_order_relaxed);
+    is_running.store(true, std::memory_order_release);
+    worker = std::thread(&GeomRenderer::run, this, fps);
+    return 0;
+}
+
+void GeomRenderer::stop()
+{
+    is_stopping.store(true, std::memory_order_release);
+    if(worker.joinable()) worker.join();
+}
+
+void GeomRenderer::publish(const int32_t _curriter, const int32_t _maxiters, const uint8_t _thickness)
+{
+    // solver side: fill the back slot and swap it into the middle, never
+    // waits on the render thread
+    Snapshot& snap = snaps[snap_back];
+    const auto& gsmodels = gs.get_models();
+    const int32_t num_models = std::min<std::size_t>(gsmodels.size(), snap.poses.size());
+    for(int32_t i=0; i<num_models; ++i) snap.poses[i] = gsmodels[i].get_pose();
+    snap.curriter = _curriter;
+    snap.maxiters = _maxiters;
+    snap.thickness = _thickness;
+    snap_back = snap_state.exchange(snap_back|4, std::memory_order_acq_rel)&3;
+}
+
+void GeomRenderer::run(const double fps)
+{
+#ifdef SIMUGEOM_NO_SDL
+    (void)fps;
+    is_running.store(false, std::memory_order_release);
+#else
+    if(initSDL()!=0)
+    {
+        is_running.store(false, std::memory_order_release);
+        return;
+    }
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0/fps));
+    auto next = std::chrono::steady_clock::now();
+    while(!is_stopping.load(std::memory_order_acquire))
+    {
+        if(snap_state.load(std::memory_order_acquire)&4)
         {
-            char str[128];
-            sprintf(str, "%6d/%6d", curriter, maxiters);
-            draw_text(1.2*(gs.bbox.pos(0,0)-gs.bbox.rad(0,0)), 1.2*(gs.bbox.pos(1,0)+gs.bbox.rad(1,0)), str);
+            snap_front = snap_state.exchange(snap_front, std::memory_order_acq_rel)&3;
+            const Snapshot& snap = snaps[snap_front];
+            curriter = snap.curriter;
+            maxiters = snap.maxiters;
+            thickness = snap.thickness;
+            SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+            SDL_RenderClear(renderer);
+            draw_axes();
+            draw_models(&snap.poses);
+            SDL_RenderPresent(renderer);
         }
-        SDL_RenderPresent(renderer);
         refresh();
+        // a slow frame pushes the next one back instead of bursting
+        next = std::max(next+period, std::chrono::steady_clock::now());
+        std::this_thread::sleep_until(next);
     }
+    // the window belongs to this thread
+    render_ready = false;
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    window = nullptr;
+    renderer = nullptr;
+    SDL_Quit();
+    is_running.store(false, std::memory_order_release);
+#endif
 }
 
 void GeomRenderer::generate_mesh()
@@ -335,6 +709,36 @@ void GeomRenderer::generate_mesh()
 
 }
 
+int GeomRenderer::save(const char* fname)
+{
+    // writes the current frame as png when the name ends in .png, as
+    // binary ppm otherwise
+    const uint8_t* rgba = nullptr;
+    std::vector<uint8_t> buf;
+    if(backend==Backend::Software)
+    {
+        rgba = pixels.data();
+    }
+    else
+    {
+#ifndef SIMUGEOM_NO_SDL
+        // the window is only readable from the thread that owns it
+        if(is_running.load(std::memory_order_acquire) || !render_ready) return -1;
+        buf.resize(std::size_t(width)*height*4);
+        if(SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, buf.data(), 4*width)!=0) return -1;
+        rgba = buf.data();
+#else
+        return -1;
+#endif
+    }
+    const std::size_t len = std::strlen(fname);
+    if(len>=4 && std::strcmp(fname+len-4, ".png")==0)
+    {
+        return write_png(fname, rgba, width, height);
+    }
+    return write_ppm(fname, rgba, width, height);
+}
+
 int GeomRenderer::export_mesh(const char* fname)
 {
     if(m==nullptr) return -1;
@@ -28,26 +28,33 @@
 #include "../include/GeomScene.h"
 #include "../include/GeomModel.h"
 #include "../include/ObjClassSet.h"
+#include "../include/GeomKernels.h"
 #include <cmath>
 #include <ctime>
 #include <chrono>
+#include <limits>
+#include <algorithm>
 #include <meshlib.h>
 
 namespace simugeom
 {
 
+// get_bb_radius_max bounds every bb radius up to rounding, so a term whose
+// bound is beaten by this factor is exactly zero and needs no trigonometry
+static constexpr double bb_bound_slack = 1.0+1e-9;
+
 GeomScene::GeomScene()
-    : param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0)
+    : param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0), philox(seed), rng_mode(RngMode::Sequential), num_scatters(0), use_pair_cache(false)
 {
 }
 
 GeomScene::GeomScene(const ObjClassSet& _classes)
-    : classes(_classes), param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0)
+    : classes(_classes), param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0), philox(seed), rng_mode(RngMode::Sequential), num_scatters(0), use_pair_cache(false)
 {
 }
 
 GeomScene::GeomScene(ObjClassSet&& _classes)
-    : classes(_classes), param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0)
+    : classes(_classes), param_alpha(2.0), seed(std::chrono::system_clock::now().time_since_epoch().count()), rng(seed), unidist(-1.0, 1.0), philox(seed), rng_mode(RngMode::Sequential), num_scatters(0), use_pair_cache(false)
 {
 }
 
@@ -68,7 +75,7 @@ int GeomScene::insert(GeomModel&& gm)
 {
     if(gm.get_class_id()<0 ||gm.get_class_id()>classes.get_num_classes()) return -1;
     const int old_num_models = models.size();
-    models.push_back(gm);
+    models.push_back(std::move(gm));
     models[old_num_models].set_object_id(old_num_models); /* force set oid */
     return 0;
 }
@@ -135,7 +142,9 @@ const std::vector<double>& GeomScene::get_reco_angles(int oid0, int oid1) const
 
 double GeomScene::get_cost_bb_intersect(int oid0, int oid1) const
 {
-    return std::max(0.0, get_bb_dist(oid0, oid1)-get_dist(oid0, oid1));
+    const auto dist = get_dist(oid0, oid1);
+    if(dist>bb_bound_slack*get_bb_dist_diag(oid0, oid1)) return 0.0;
+    return std::max(0.0, get_bb_dist(oid0, oid1)-dist);
 }
 
 double GeomScene::get_cost_bb_intersect_diag(int oid0, int oid1) const
@@ -146,20 +155,25 @@ double GeomScene::get_cost_bb_intersect_diag(int oid0, int oid1) const
 double GeomScene::get_cost_pairwise_dist(int oid0, int oid1) const
 {
     double cost = 0.0;
-    const auto bb = get_bb_dist(oid0, oid1);
     const auto dist = get_dist(oid0, oid1);
-    if(dist<bb) cost = std::pow(bb/dist, param_alpha);
     const auto mrd = get_max_reco_dist(oid0, oid1);
     if(dist>mrd)
     {
-        cost = std::pow(dist/mrd, param_alpha);
+        // too far overrides too near
+        return std::pow(dist/mrd, param_alpha);
     }
+    if(dist>bb_bound_slack*get_bb_dist_diag(oid0, oid1)) return cost;
+    const auto bb = get_bb_dist(oid0, oid1);
+    if(dist<bb) cost = std::pow(bb/dist, param_alpha);
     return cost;
 }
 
 double GeomScene::get_cost_visibility(int oid0, int oid1, int oid2) const
 {
-    return std::max(0.0, get_bb_dist(oid0, oid1, oid2)-get_dist(oid0, oid1, oid2));
+    const auto dist = get_dist(oid0, oid1, oid2);
+    const auto bbmax = models[oid0].get_bb_radius_max()+get_bb_dist_diag(oid1, oid2)+get_dist(oid1, oid2);
+    if(dist>bb_bound_slack*bbmax) return 0.0;
+    return std::max(0.0, get_bb_dist(oid0, oid1, oid2)-dist);
 }
 
 double GeomScene::get_cost_fixed_dist(int oid0, int oid1) const
@@ -190,83 +204,560 @@ double GeomScene::get_cost_fixed_angle(int oid0, int oid1) const
     return cost;
 }
 
+// cost engine kernels, reading the packed arrays of the scene
+
+// parallel partial sums are added in index order so the total does not
+// depend on the thread count
+static inline double get_sum_in_order(const std::vector<double>& parts)
+{
+    double sum = 0.0;
+    for(const double p : parts) sum += p;
+    return sum;
+}
+
+static inline double soa_bb_radius_from(const GeomSceneSoA& s, const int i, const double x, const double y)
+{
+    return get_bb_radius_kernel(s.type[i], s.rx[i], s.ry[i], s.x[i], s.y[i], s.cr[i], s.sr[i], x, y);
+}
+
+static inline double soa_dist(const GeomSceneSoA& s, const int i, const int j)
+{
+    const double dx = s.x[i]-s.x[j];
+    const double dy = s.y[i]-s.y[j];
+    return std::sqrt(dx*dx+dy*dy);
+}
+
+static inline double soa_bb_dist(const GeomSceneSoA& s, const int i, const int j)
+{
+    return soa_bb_radius_from(s, i, s.x[j], s.y[j])+soa_bb_radius_from(s, j, s.x[i], s.y[i]);
+}
+
+static inline double soa_cost_visibility(const GeomSceneSoA& s, const int k, const int i, const int j, const double dist_ij)
+{
+    const double cx = 0.5*(s.x[i]+s.x[j]);
+    const double cy = 0.5*(s.y[i]+s.y[j]);
+    const double dx = s.x[k]-cx;
+    const double dy = s.y[k]-cy;
+    const double dist = std::sqrt(dx*dx+dy*dy);
+    if(dist>bb_bound_slack*(s.radmax[k]+(s.radmax[i]+s.radmax[j])+dist_ij)) return 0.0;
+    const double bb = soa_bb_radius_from(s, k, cx, cy)+(s.rself[i]+s.rself[j]+dist_ij);
+    return std::max(0.0, bb-dist);
+}
+
+double GeomScene::get_cost_intersect(const GeomSceneSoA& s, int oid0, int oid1) const
+{
+    const double dist = soa_dist(s, oid0, oid1);
+    if(dist>bb_bound_slack*(s.radmax[oid0]+s.radmax[oid1])) return 0.0;
+    if(s.get_is_fixed(oid0) || s.get_is_fixed(oid1))
+    {
+        return 1000*std::max(0.0, soa_bb_dist(s, oid0, oid1)-dist);
+    }
+    return 500*std::max(0.0, (s.radmax[oid0]+s.radmax[oid1])-dist);
+}
+
+double GeomScene::get_cost_pair_dist(const GeomSceneSoA& s, int oid0, int oid1) const
+{
+    double cost = 0.0;
+    const double dist = soa_dist(s, oid0, oid1);
+    const double mrd = ctable.get_max_reco_dist(s.cid[oid0], s.cid[oid1]);
+    if(dist>mrd)
+    {
+        // too far overrides too near
+        return 0.1*std::pow(dist/mrd, param_alpha);
+    }
+    if(dist>bb_bound_slack*(s.radmax[oid0]+s.radmax[oid1])) return cost;
+    const double bb = soa_bb_dist(s, oid0, oid1);
+    if(dist<bb) cost = 0.1*std::pow(bb/dist, param_alpha);
+    return cost;
+}
+
+double GeomScene::get_cost_visibility_of_pair(const GeomSceneSoA& s, int oid0, int oid1, std::vector<int>& cands) const
+{
+    // visibility of the pair from all other models, only the models near
+    // enough to the pair centroid can block it
+    double cost = 0.0;
+    const double dist = soa_dist(s, oid0, oid1);
+    const double r = bb_bound_slack*(s.radmax[oid0]+s.radmax[oid1]+dist);
+    grid.query(0.5*(s.x[oid0]+s.x[oid1]), 0.5*(s.y[oid0]+s.y[oid1]), r, cands);
+    for(const int k : cands)
+    {
+        if(k==oid0||k==oid1)
+        {
+            continue;
+        }
+        cost += 0.05*soa_cost_visibility(s, k, oid0, oid1, dist);
+    }
+    return cost;
+}
+
+double GeomScene::get_cost_nearest_wall(const GeomSceneSoA& s, int oid, const bool is_scan) const
+{
+    // find the nearest wall for non-wall objects only
+    double nearest_wall_dist;
+    const int nearest_wid = wfield.query_nearest(s, oid, nearest_wall_dist, is_scan);
+    if(nearest_wid<0) return 0.0;
+
+    // now once got nearest wall
+    double cost_angle = 0.0;
+    const double* rang = ctable.get_reco_angles(s.cid[oid], s.cid[nearest_wid]);
+    const double angle = s.rot[oid]-s.rot[nearest_wid];
+    const int32_t valn = ctable.get_num_reco_angles(s.cid[oid], s.cid[nearest_wid]);
+    for(int i=0; i<valn; ++i)
+    {
+        double anglediff = rang[i]-angle;
+        anglediff = std::atan2(std::sin(anglediff), std::cos(anglediff));
+        cost_angle = (i==0)?(anglediff*anglediff):std::min(cost_angle, anglediff*anglediff);
+    }
+    const double distdiff = nearest_wall_dist-ctable.get_reco_dist(s.cid[oid], s.cid[nearest_wid]);
+    return 3*cost_angle+0.05*(distdiff*distdiff);
+}
+
+void GeomScene::update_index() const
+{
+    // bring the packed arrays and the indices up to the current poses
+    const int32_t num_models = models.size();
+    if(soa.size()!=num_models || ctable.get_num_classes()!=classes.get_num_classes())
+    {
+        classes.compile(ctable);
+        soa.build(models, classes);
+        grid.build(soa);
+        tree.build(soa);
+        wfield.build(soa, bbox, boundary.get_points().size()>0);
+        pcache.clear();
+        return;
+    }
+    std::vector<int> changed;
+    soa.sync(models, classes, changed);
+    for(const int oid : changed)
+    {
+        grid.update(soa, oid);
+        tree.update(soa, oid);
+        // the wall field only depends on fixed models
+        if(soa.get_is_fixed(oid)) wfield.clear();
+    }
+    if(!wfield.get_is_built())
+    {
+        wfield.build(soa, bbox, boundary.get_points().size()>0);
+    }
+}
+
 double GeomScene::get_cost_total() const
 {
     double tcost = 0.0;
-    const int32_t num_models = models.size();
-    #pragma omp parallel for reduction(+:tcost)
-    for(int i=0; i<num_models; ++i)
+    update_index();
+    const std::vector<int32_t>& movable = soa.movable;
+    const std::vector<int32_t>& fixed = soa.fixed;
+    const int32_t num_movable = movable.size();
+    if(use_pair_cache)
     {
+        refresh_pair_cache(-1);
+    }
+    else
+    {
+        // intersections only for the pairs overlapping in the broadphase
+        std::vector<std::pair<int, int>> pairs;
+        tree.query_pairs(pairs);
+        const int32_t num_pairs = pairs.size();
+        std::vector<double> parts(num_pairs);
+        #pragma omp parallel for
+        for(int p=0; p<num_pairs; ++p)
+        {
+            parts[p] = get_cost_intersect(soa, pairs[p].first, pairs[p].second);
+        }
+        tcost += get_sum_in_order(parts);
+    }
+    // fixed-fixed pairs carry no cost, so every pair has a movable model
+    std::vector<double> parts(num_movable);
+    #pragma omp parallel for
+    for(int m=0; m<num_movable; ++m)
+    {
+        std::vector<int> cands;
         double subtcost = 0.0;
-        const bool is_fixed_i = classes.get_class(models[i].get_class_id()).is_fixed;
-        for(int j=(i+1); j<num_models; ++j)
+        const int i = movable[m];
+        const double* row = use_pair_cache?pcache.get_row(i):nullptr;
+        for(int n=(m+1); n<num_movable; ++n)
         {
-            const bool is_fixed_j = classes.get_class(models[j].get_class_id()).is_fixed;
+            subtcost += row?row[movable[n]]:get_cost_pair_dist(soa, i, movable[n]);
+            subtcost += get_cost_visibility_of_pair(soa, i, movable[n], cands);
+        }
+        for(const int j : fixed)
+        {
+            const int i0 = std::min(i, j);
+            const int i1 = std::max(i, j);
+            subtcost += row?row[j]:get_cost_pair_dist(soa, i0, i1);
+            subtcost += get_cost_visibility_of_pair(soa, i0, i1, cands);
+        }
+        subtcost += use_pair_cache?pcache.wall[i]:get_cost_nearest_wall(soa, i);
+        parts[m] = subtcost;
+    }
+    tcost += get_sum_in_order(parts);
+    return tcost;
+}
 
-            if(is_fixed_i && is_fixed_j) continue;
+double GeomScene::get_cost_local(int oid) const
+{
+    update_index();
+    if(use_pair_cache) return get_cost_local_pairs(oid)+get_cost_local_of(soa, oid, true);
+    return get_cost_local_of(soa, oid, false);
+}
 
-            // subtcost += 1000*get_cost_bb_intersect(i, j);
-            if(is_fixed_i || is_fixed_j)
+double GeomScene::get_cost_local(int oid, const GeomPose& pose) const
+{
+    // local cost of oid moved to pose, evaluated on a copy of the packed
+    // arrays so that the scene is left untouched
+    update_index();
+    GeomSceneSoA s = soa;
+    s.set_pose(oid, pose);
+    return get_cost_local_of(s, oid, false);
+}
+
+void GeomScene::get_cost_local(int oid, const std::vector<GeomPose>& poses, std::vector<double>& costs) const
+{
+    // local costs of oid for all the poses at once, one pose per thread
+    // with its own scratch copy of the packed arrays; with the pair cache
+    // the pair rows are kept for keep_cost_local
+    update_index();
+    const int32_t num_poses = poses.size();
+    const int32_t num_models = soa.size();
+    costs.resize(num_poses);
+    if(use_pair_cache)
+    {
+        pcache.proposed.resize(std::size_t(num_poses)*num_models);
+        pcache.proposed_wall.resize(num_poses);
+        pcache.proposed_x.resize(num_poses);
+        pcache.proposed_y.resize(num_poses);
+        pcache.proposed_rot.resize(num_poses);
+        pcache.proposed_oid = oid;
+    }
+    #pragma omp parallel
+    {
+        GeomSceneSoA s = soa;
+        #pragma omp for schedule(dynamic)
+        for(int k=0; k<num_poses; ++k)
+        {
+            s.set_pose(oid, poses[k]);
+            if(!use_pair_cache)
             {
-                subtcost += 1000*get_cost_bb_intersect(i, j);
+                costs[k] = get_cost_local_of(s, oid, false);
+                continue;
             }
-            else
+            double cost = get_cost_pair_row(s, oid, pcache.proposed.data()+std::size_t(k)*num_models);
+            double wall = 0.0;
+            if(s.get_is_fixed(oid))
             {
-                subtcost += 500*get_cost_bb_intersect_diag(i, j);
+                for(const int i : s.movable) wall += get_cost_nearest_wall(s, i, true);
             }
-            subtcost += 0.1*get_cost_pairwise_dist(i, j);
-            for(int k=0; k<num_models; ++k)
+            else
             {
-                if(k==i||k==j)
-                {
-                    continue;
-                }
-                subtcost += 0.05*get_cost_visibility(k, i, j);
+                wall = get_cost_nearest_wall(s, oid);
             }
+            pcache.proposed_wall[k] = wall;
+            pcache.proposed_x[k] = s.x[oid];
+            pcache.proposed_y[k] = s.y[oid];
+            pcache.proposed_rot[k] = s.rot[oid];
+            costs[k] = cost+wall+get_cost_local_of(s, oid, true);
         }
-        // find the nearest wall for non-wall objects (i) only
-        if(!classes.get_class(models[i].get_class_id()).is_fixed)
+    }
+}
+
+double GeomScene::get_cost_local_of(const GeomSceneSoA& s, int oid, const bool use_cache) const
+{
+    // sum of all the terms of get_cost_total that depend on the pose of
+    // oid in s; the indices only have to be current for the other models.
+    // With use_cache the pair and wall terms are left to the caller
+    double tcost = 0.0;
+    const std::vector<int32_t>& movable = s.movable;
+    const std::vector<int32_t>& fixed = s.fixed;
+    const int32_t num_models = s.size();
+    const int32_t num_movable = movable.size();
+    const bool is_fixed_o = s.get_is_fixed(oid);
+    if(!use_cache)
+    {
+        std::vector<int> cands;
+        tree.query(s, oid, cands);
+        for(const int i : cands)
         {
-            int nearest_wid = -1;
-            double nearest_wall_dist = std::numeric_limits<double>::max();
-            for(int j=0; j<num_models; ++j)
-            {
-                if(!classes.get_class(models[j].get_class_id()).is_fixed ||(i==j)) continue;
-                double curr_wall_dist = get_dist(i, j);
-                if(curr_wall_dist<nearest_wall_dist)
-                {
-                    nearest_wall_dist = curr_wall_dist;
-                    nearest_wid = j;
-                }
-            }
-            {
-                // now once got nearest wall
-                subtcost += 3*get_cost_fixed_angle(i, nearest_wid);
-                subtcost += 0.05*get_cost_fixed_dist(i, nearest_wid);
-            }
+            tcost += get_cost_intersect(s, std::min(oid, i), std::max(oid, i));
+        }
+    }
+    // pairs (oid, i) with all their visibility triplets, a fixed oid only
+    // pairs with the movable models
+    const int32_t num_partners = is_fixed_o?num_movable:num_models;
+    std::vector<double> parts(num_partners, 0.0);
+    #pragma omp parallel for
+    for(int p=0; p<num_partners; ++p)
+    {
+        const int i = is_fixed_o?movable[p]:p;
+        if(i==oid) continue;
+        std::vector<int> cands;
+        const int i0 = std::min(oid, i);
+        const int i1 = std::max(oid, i);
+        double subtcost = 0.0;
+        if(!use_cache) subtcost += get_cost_pair_dist(s, i0, i1);
+        subtcost += get_cost_visibility_of_pair(s, i0, i1, cands);
+        parts[p] = subtcost;
+    }
+    tcost += get_sum_in_order(parts);
+    // oid as the viewer of pairs (i, j), with the radii of oid towards
+    // all the pair centroids of row i taken in one batch
+    parts.assign(num_movable, 0.0);
+    #pragma omp parallel for
+    for(int m=0; m<num_movable; ++m)
+    {
+        const int i = movable[m];
+        if(i==oid) continue;
+        std::vector<int> cols;
+        std::vector<double> cx, cy, rad;
+        double subtcost = 0.0;
+        for(int n=(m+1); n<num_movable; ++n)
+        {
+            if(movable[n]!=oid) cols.push_back(movable[n]);
+        }
+        for(const int j : fixed)
+        {
+            if(j!=oid) cols.push_back(j);
+        }
+        const int32_t cnt = cols.size();
+        cx.resize(cnt);
+        cy.resize(cnt);
+        rad.resize(cnt);
+        for(int32_t c=0; c<cnt; ++c)
+        {
+            cx[c] = 0.5*(s.x[i]+s.x[cols[c]]);
+            cy[c] = 0.5*(s.y[i]+s.y[cols[c]]);
+        }
+        get_bb_radius_batch(s.type[oid], s.rx[oid], s.ry[oid], s.x[oid], s.y[oid],
+                            s.cr[oid], s.sr[oid], cx.data(), cy.data(), rad.data(), cnt);
+        for(int32_t c=0; c<cnt; ++c)
+        {
+            const int j = cols[c];
+            const double dx = s.x[oid]-cx[c];
+            const double dy = s.y[oid]-cy[c];
+            const double bb = rad[c]+(s.rself[i]+s.rself[j]+soa_dist(s, i, j));
+            subtcost += 0.05*std::max(0.0, bb-std::sqrt(dx*dx+dy*dy));
+        }
+        // a moving wall changes the nearest wall terms of everyone else,
+        // the wall field only knows its indexed pose
+        if(is_fixed_o && !use_cache)
+        {
+            subtcost += get_cost_nearest_wall(s, i, &s!=&soa);
         }
-        tcost = tcost+subtcost;
+        parts[m] = subtcost;
+    }
+    tcost += get_sum_in_order(parts);
+    if(!is_fixed_o && !use_cache)
+    {
+        tcost += get_cost_nearest_wall(s, oid);
     }
     return tcost;
 }
 
-const GeomPose GeomScene::generate_random_pose()
+double GeomScene::get_cost_pair_row(const GeomSceneSoA& s, int oid, double* row) const
+{
+    // intersection and pair distance costs of oid against every model
+    const int32_t num_models = s.size();
+    const bool is_fixed_o = s.get_is_fixed(oid);
+    double cost = 0.0;
+    for(int i=0; i<num_models; ++i)
+    {
+        if(i==oid || (is_fixed_o && s.get_is_fixed(i)))
+        {
+            row[i] = 0.0;
+            continue;
+        }
+        const int i0 = std::min(oid, i);
+        const int i1 = std::max(oid, i);
+        row[i] = get_cost_intersect(s, i0, i1)+get_cost_pair_dist(s, i0, i1);
+        cost += row[i];
+    }
+    return cost;
+}
+
+void GeomScene::refresh_pair_cache(int except) const
+{
+    // recompute the rows of the models moved since they were cached, all
+    // but except whose pose may be a proposal
+    const int32_t num_models = soa.size();
+    if(pcache.size()!=num_models) pcache.resize(num_models);
+    std::vector<int> stale;
+    bool is_wall_moved = false;
+    for(int i=0; i<num_models; ++i)
+    {
+        if(i==except || pcache.get_is_current(soa, i)) continue;
+        stale.push_back(i);
+        is_wall_moved = is_wall_moved || soa.get_is_fixed(i);
+    }
+    if(stale.empty()) return;
+    if(except>=0 && !pcache.get_is_current(soa, except))
+    {
+        // the refreshed rows see the proposal of except
+        pcache.valid[except] = 0;
+    }
+    const int32_t num_stale = stale.size();
+    #pragma omp parallel for
+    for(int s=0; s<num_stale; ++s)
+    {
+        const int i = stale[s];
+        get_cost_pair_row(soa, i, pcache.get_row(i));
+        pcache.wall[i] = soa.get_is_fixed(i)?0.0:get_cost_nearest_wall(soa, i);
+    }
+    for(const int i : stale)
+    {
+        const double* row = pcache.get_row(i);
+        for(int j=0; j<num_models; ++j)
+        {
+            pcache.cost[std::size_t(j)*num_models+i] = row[j];
+        }
+        pcache.set_current(soa, i);
+    }
+    if(is_wall_moved)
+    {
+        const int32_t num_movable = soa.movable.size();
+        #pragma omp parallel for
+        for(int m=0; m<num_movable; ++m)
+        {
+            pcache.wall[soa.movable[m]] = get_cost_nearest_wall(soa, soa.movable[m]);
+        }
+    }
+}
+
+double GeomScene::get_cost_local_pairs(int oid) const
+{
+    // cached pair and wall terms of oid, a pose not cached yet goes to
+    // the scratch row until it is committed or rolled back
+    refresh_pair_cache(oid);
+    const int32_t num_models = soa.size();
+    const bool is_fixed_o = soa.get_is_fixed(oid);
+    double cost = 0.0;
+    if(pcache.get_is_current(soa, oid))
+    {
+        const double* row = pcache.get_row(oid);
+        for(int i=0; i<num_models; ++i) cost += row[i];
+        if(is_fixed_o)
+        {
+            for(const int i : soa.movable) cost += pcache.wall[i];
+        }
+        else
+        {
+            cost += pcache.wall[oid];
+        }
+        return cost;
+    }
+    cost = get_cost_pair_row(soa, oid, pcache.scratch.data());
+    double wall = 0.0;
+    if(is_fixed_o)
+    {
+        for(const int i : soa.movable) wall += get_cost_nearest_wall(soa, i);
+    }
+    else
+    {
+        wall = get_cost_nearest_wall(soa, oid);
+    }
+    pcache.scratch_wall = wall;
+    pcache.scratch_x = soa.x[oid];
+    pcache.scratch_y = soa.y[oid];
+    pcache.scratch_rot = soa.rot[oid];
+    pcache.scratch_oid = oid;
+    return cost+wall;
+}
+
+void GeomScene::set_pair_cache(const bool enable)
+{
+    use_pair_cache = enable;
+    pcache.resize(enable?models.size():0);
+}
+
+void GeomScene::keep_cost_local(int oid, int k)
+{
+    // moves the row of pose k of the last batched get_cost_local of oid
+    // to the scratch row, for a proposal scored on a copy of the scene
+    if(!use_pair_cache || pcache.proposed_oid!=oid || k<0 || k>=int(pcache.proposed_wall.size())) return;
+    const int32_t num_models = soa.size();
+    if(pcache.scratch.size()!=std::size_t(num_models) || pcache.proposed.size()<std::size_t(k+1)*num_models) return;
+    std::copy(pcache.proposed.begin()+std::size_t(k)*num_models, pcache.proposed.begin()+std::size_t(k+1)*num_models,
+              pcache.scratch.begin());
+    pcache.scratch_wall = pcache.proposed_wall[k];
+    pcache.scratch_x = pcache.proposed_x[k];
+    pcache.scratch_y = pcache.proposed_y[k];
+    pcache.scratch_rot = pcache.proposed_rot[k];
+    pcache.scratch_oid = oid;
+}
+
+void GeomScene::commit_cost_local(int oid)
+{
+    // keeps the scratch row of the accepted pose of oid
+    if(!use_pair_cache) return;
+    update_index();
+    if(pcache.scratch_oid!=oid || pcache.scratch_x!=soa.x[oid] || pcache.scratch_y!=soa.y[oid]
+            || pcache.scratch_rot!=soa.rot[oid] || pcache.size()!=soa.size())
+    {
+        pcache.scratch_oid = -1;
+        return;
+    }
+    const int32_t num_models = soa.size();
+    double* row = pcache.get_row(oid);
+    for(int j=0; j<num_models; ++j)
+    {
+        row[j] = pcache.scratch[j];
+        pcache.cost[std::size_t(j)*num_models+oid] = row[j];
+    }
+    if(soa.get_is_fixed(oid))
+    {
+        for(const int i : soa.movable) pcache.wall[i] = get_cost_nearest_wall(soa, i);
+    }
+    else
+    {
+        pcache.wall[oid] = pcache.scratch_wall;
+    }
+    pcache.set_current(soa, oid);
+    pcache.scratch_oid = -1;
+}
+
+void GeomScene::rollback_cost_local(int oid)
+{
+    // the cached row of oid stays valid for its restored pose
+    if(!use_pair_cache) return;
+    if(pcache.scratch_oid==oid) pcache.scratch_oid = -1;
+}
+
+const std::vector<int32_t>& GeomScene::get_movable_ids() const
+{
+    update_index();
+    return soa.movable;
+}
+
+const std::vector<int32_t>& GeomScene::get_fixed_ids() const
+{
+    update_index();
+    return soa.fixed;
+}
+
+double GeomScene::get_cost_delta(int oid, const GeomPose& pose)
+{
+    return get_cost_local(oid, pose)-get_cost_local(oid);
+}
+
+const GeomPose GeomScene::generate_random_pose(const int oid)
 {
     // implement better generation by considering equal density along
     // x and y directions without scaling, but using rejection
+    GeomPhiloxStream stream(philox, GeomRngDomain::Scatter, oid, num_scatters, 0);
+    auto get_uniform = [&]() {
+        return (rng_mode==RngMode::Counter)?stream.get_uniform():unidist(rng);
+    };
     GeomPose pose;
     if(boundary.get_points().size()>0)
     {
-        pose.pos(0,0) = bbox.pos(0,0)+bbox.rad(0,0)*unidist(rng);
-        pose.pos(1,0) = bbox.pos(1,0)+bbox.rad(1,0)*unidist(rng);
+        pose.pos(0,0) = bbox.pos(0,0)+bbox.rad(0,0)*get_uniform();
+        pose.pos(1,0) = bbox.pos(1,0)+bbox.rad(1,0)*get_uniform();
     }
     else
     {
-        pose.pos(0,0) = unidist(rng);
-        pose.pos(1,0) = unidist(rng);
+        pose.pos(0,0) = get_uniform();
+        pose.pos(1,0) = get_uniform();
     }
     pose.pos(2,0) = 0.0;
-    pose.rot = MESH_PI*unidist(rng);
+    pose.rot = MESH_PI*get_uniform();
     return pose;
 }
 
@@ -279,9 +770,40 @@ void GeomScene::scatter()
         if(!classes.get_class(tmodel.get_class_id()).is_fixed)
         {
             GeomPose& pose = tmodel.get_pose();
-            pose = generate_random_pose();
+            pose = generate_random_pose(i);
         }
     }
+    ++num_scatters;
+}
+
+double GeomScene::get_uniform(const GeomRngDomain domain, const uint32_t oid, const uint32_t iter, const uint32_t k)
+{
+    if(rng_mode==RngMode::Counter)
+    {
+        GeomPhiloxStream stream(philox, domain, oid, iter, k);
+        return stream.get_uniform();
+    }
+    return unidist(rng);
+}
+
+void GeomScene::shuffle(std::vector<int>& seq, const uint32_t iter)
+{
+    if(rng_mode!=RngMode::Counter)
+    {
+        std::shuffle(std::begin(seq), std::end(seq), rng);
+        return;
+    }
+    // fisher-yates from one batch of counter based uniforms
+    const int n = seq.size();
+    if(n<2) return;
+    std::vector<double> us(n);
+    GeomPhiloxStream stream(philox, GeomRngDomain::Shuffle, 0, iter, 0);
+    stream.get_uniforms(us.data(), n);
+    for(int i=n-1; i>0; --i)
+    {
+        const int j = std::min(i, int(0.5*(us[i]+1.0)*(i+1)));
+        std::swap(seq[i], seq[j]);
+    }
 }
 
 
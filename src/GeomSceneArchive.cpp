@@ -0,0 +1,162 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSceneArchive.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomSceneArchive.
+ */
+
+#include "../include/GeomSceneArchive.h"
+#include "../include/GeomSceneIO.h"
+#include <cstring>
+
+namespace simugeom
+{
+
+static const char archive_magic[8] = {'G','S','C','N','A','R','C','1'};
+
+GeomSceneArchiveWriter::GeomSceneArchiveWriter()
+{
+}
+
+GeomSceneArchiveWriter::~GeomSceneArchiveWriter()
+{
+    close();
+}
+
+int GeomSceneArchiveWriter::open(const char* fname)
+{
+    close();
+    offsets.clear();
+    ofs.open(fname, std::ios::binary|std::ios::trunc);
+    return ofs.is_open()?0:-1;
+}
+
+int GeomSceneArchiveWriter::append(const GeomScene& gs)
+{
+    if(!ofs.is_open()) return -1;
+    // one buffer reused across the appends, and every scene starts on a
+    // 32 byte boundary so that its pose records can be used in place
+    const char pad[32] = {0};
+    const uint64_t end = ofs.tellp();
+    ofs.write(pad, (32-end%32)%32);
+    const uint64_t offset = ofs.tellp();
+    GeomSceneWriter gsw(gs);
+    gsw.serialize(buf);
+    ofs.write(buf.data(), buf.size());
+    if(!ofs.good()) return -1;
+    offsets.push_back(offset);
+    return 0;
+}
+
+int GeomSceneArchiveWriter::close()
+{
+    if(!ofs.is_open()) return 0;
+    // the end of the last scene closes the offset list, which is padded
+    // to 8 bytes so that it can be used in place from a mapping
+    const uint64_t end = ofs.tellp();
+    const uint64_t num_scenes = offsets.size();
+    const char pad[8] = {0};
+    ofs.write(pad, (8-end%8)%8);
+    ofs.write(reinterpret_cast<const char *>(offsets.data()), sizeof(uint64_t)*num_scenes);
+    ofs.write(reinterpret_cast<const char *>(&end), sizeof(uint64_t));
+    ofs.write(reinterpret_cast<const char *>(&num_scenes), sizeof(uint64_t));
+    ofs.write(archive_magic, sizeof(archive_magic));
+    const bool is_good = ofs.good();
+    ofs.close();
+    return is_good?0:-1;
+}
+
+GeomSceneArchiveReader::GeomSceneArchiveReader() : offsets(nullptr), num_scenes(0)
+{
+}
+
+GeomSceneArchiveReader::~GeomSceneArchiveReader()
+{
+}
+
+int GeomSceneArchiveReader::open(const char* fname)
+{
+    close();
+    if(mfile.open(fname)!=0) return -1;
+    const char* data = mfile.get_data();
+    const std::size_t size = mfile.get_size();
+    const std::size_t tail = sizeof(uint64_t)+sizeof(archive_magic);
+    if(size<tail+sizeof(uint64_t) || std::memcmp(data+size-sizeof(archive_magic), archive_magic, sizeof(archive_magic))!=0)
+    {
+        close();
+        return -1;
+    }
+    uint64_t n;
+    std::memcpy(&n, data+size-tail, sizeof(uint64_t));
+    // the index must fit in front of the footer and be aligned for direct
+    // use, the offsets must be ordered and end at the padding before it
+    const std::size_t index_size = sizeof(uint64_t)*(n+1);
+    if(n>(size-tail)/sizeof(uint64_t)-1 || ((size-tail-index_size)%sizeof(uint64_t))!=0)
+    {
+        close();
+        return -1;
+    }
+    const uint64_t* index = reinterpret_cast<const uint64_t*>(data+size-tail-index_size);
+    for(uint64_t i=0; i<n; ++i)
+    {
+        if(index[i]>index[i+1])
+        {
+            close();
+            return -1;
+        }
+    }
+    if(index[n]>size-tail-index_size || (size-tail-index_size-index[n])>=sizeof(uint64_t))
+    {
+        close();
+        return -1;
+    }
+    offsets = index;
+    num_scenes = n;
+    return 0;
+}
+
+void GeomSceneArchiveReader::close()
+{
+    mfile.close();
+    offsets = nullptr;
+    num_scenes = 0;
+}
+
+int GeomSceneArchiveReader::get_scene_data(const int64_t n, const char*& data, std::size_t& size) const
+{
+    if(n<0 || n>=num_scenes) return -1;
+    data = mfile.get_data()+offsets[n];
+    size = offsets[n+1]-offsets[n];
+    return 0;
+}
+
+int GeomSceneArchiveReader::read(const int64_t n, GeomScene& gs) const
+{
+    const char* data;
+    std::size_t size;
+    if(get_scene_data(n, data, size)!=0) return -1;
+    GeomSceneReader gsr(gs);
+    return gsr.read(data, size);
+}
+
+}
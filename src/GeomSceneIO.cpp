@@ -26,7 +26,20 @@
  */
 
 #include "../include/GeomSceneIO.h"
+#include "../include/GeomMappedFile.h"
+#include "../include/GeomChecksum.h"
 #include <fstream>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 namespace simugeom
 {
@@ -39,109 +52,164 @@ GeomSceneReader::~GeomSceneReader()
 {
 }
 
-int GeomSceneReader::read(const char* fname)
+template<typename T>
+static inline T get_field(const char*& p)
 {
-    std::ifstream ifs(fname, std::ios::binary);
-    if(!ifs.is_open()) return -1;
-
-    // param_alpha
-    double param_alpha;
-    ifs.read(reinterpret_cast<char *>(&param_alpha), sizeof(double));
-
-    // seed
-    uint32_t seed;
-    ifs.read(reinterpret_cast<char *>(&seed), sizeof(uint32_t));
-
-    // classes
-    int32_t num_classes;
-    ifs.read(reinterpret_cast<char *>(&num_classes), sizeof(int32_t));
+    T val;
+    std::memcpy(&val, p, sizeof(T));
+    p += sizeof(T);
+    return val;
+}
 
+static std::size_t get_scene_size(const char* data, const std::size_t size, const int32_t num_classes_old)
+{
+    // walks the record reading only the counts and the lengths, returns
+    // its size or 0 if it does not fit in size or is malformed
+    const char* p = data;
+    const char* end = data+size;
+    auto has = [&](const std::size_t n) { return std::size_t(end-p)>=n; };
+    const std::size_t class_size = sizeof(ObjClass::GeomType)+sizeof(uint8_t)+sizeof(uint32_t);
+    const std::size_t model_size = 2*sizeof(uint32_t)+7*sizeof(double);
+    if(!has(sizeof(double)+sizeof(uint32_t)+sizeof(int32_t))) return 0;
+    p += sizeof(double)+sizeof(uint32_t);
+    const int32_t num_classes = get_field<int32_t>(p);
+    if(num_classes<0) return 0;
     for(int32_t i=0; i<num_classes; ++i)
     {
-        char name[256];
-        ObjClass::GeomType type;
-        uint8_t is_fixed;
-        int32_t cid;
+        if(!has(sizeof(int32_t))) return 0;
+        const int32_t str_sz = get_field<int32_t>(p);
+        if(str_sz<0 || str_sz>255 || !has(str_sz+class_size)) return 0;
+        p += str_sz+class_size;
+    }
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        for(int32_t j=i; j<num_classes; ++j)
+        {
+            if(!has(2*sizeof(double)+sizeof(int32_t))) return 0;
+            p += 2*sizeof(double);
+            const int32_t valn = get_field<int32_t>(p);
+            if(valn<0 || std::size_t(end-p)/sizeof(double)<std::size_t(valn)) return 0;
+            p += valn*sizeof(double);
+        }
+    }
+    if(!has(sizeof(int32_t))) return 0;
+    const int32_t num_models = get_field<int32_t>(p);
+    if(num_models<0) return 0;
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        if(!has(sizeof(int32_t))) return 0;
+        const int32_t str_sz = get_field<int32_t>(p);
+        if(str_sz<0 || str_sz>255 || !has(str_sz+model_size)) return 0;
+        p += str_sz;
+        const int32_t cid = get_field<int32_t>(p);
+        if(cid<0 || cid>=(num_classes_old+num_classes)) return 0;
+        p += model_size-sizeof(uint32_t);
+    }
+    return p-data;
+}
+
+int GeomSceneReader::read(const char* fname)
+{
+    GeomMappedFile mfile;
+    if(mfile.open(fname)!=0) return -1;
+    return read(mfile.get_data(), mfile.get_size());
+}
 
-        int32_t str_sz;
-        ifs.read(reinterpret_cast<char *>(&str_sz), sizeof(int32_t));
-        ifs.read(reinterpret_cast<char *>(name), sizeof(char)*str_sz);
-        name[str_sz] = 0;
+int GeomSceneReader::read(const char* data, const std::size_t size)
+{
+    if(data==nullptr) return -1;
+    // v1 has no magic, so anything starting with the v2 one is taken as v2
+    if(size>=4 && std::memcmp(data, "GSCN", 4)==0)
+    {
+        return read_v2(data, size);
+    }
+    return read_v1(data, size);
+}
 
-        ifs.read(reinterpret_cast<char *>(&type), sizeof(ObjClass::GeomType));
+int GeomSceneReader::read_v1(const char* data, const std::size_t size)
+{
+    // the record is checked once up front, then the scene is built in a
+    // single unchecked pass straight from the buffer
+    const int32_t num_classes_old = gs.classes.get_num_classes();
+    if(data==nullptr || get_scene_size(data, size, num_classes_old)==0) return -1;
+    const char* p = data;
 
-        ifs.read(reinterpret_cast<char *>(&is_fixed), sizeof(uint8_t));
-        ifs.read(reinterpret_cast<char *>(&cid), sizeof(uint32_t));
+    // param_alpha and seed
+    gs.param_alpha = get_field<double>(p);
+    gs.set_seed(get_field<uint32_t>(p));
 
-        ObjClass tcls(name, type, is_fixed, cid);
-        gs.classes.insert(tcls);
+    // classes
+    const int32_t num_classes = get_field<int32_t>(p);
+    std::vector<ObjClass> objclss;
+    objclss.reserve(num_classes);
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        const int32_t str_sz = get_field<int32_t>(p);
+        std::string name(p, str_sz);
+        p += str_sz;
+        const ObjClass::GeomType type = get_field<ObjClass::GeomType>(p);
+        const uint8_t is_fixed = get_field<uint8_t>(p);
+        const int32_t cid = get_field<int32_t>(p);
+        objclss.emplace_back(std::move(name), type, is_fixed, cid);
     }
+    if(gs.classes.insert_bulk(objclss)!=0) return -1;
 
-    // now read the class parameters
+    // class parameters
     for(int32_t i=0; i<num_classes; ++i)
     {
         for(int32_t j=i; j<num_classes; ++j)
         {
-            double val;
-            ifs.read(reinterpret_cast<char *>(&val), sizeof(double));
-            gs.classes.max_reco_dist[i][j] = val;
-            gs.classes.max_reco_dist[j][i] = val;
-            ifs.read(reinterpret_cast<char *>(&val), sizeof(double));
-            gs.classes.reco_dist[i][j] = val;
-            gs.classes.reco_dist[j][i] = val;
-			int32_t valn;
-			ifs.read(reinterpret_cast<char*>(&valn), sizeof(int32_t));
-			std::vector<double> tmpval;
-			for(int32_t k=0; k<valn; ++k)
-			{
-				ifs.read(reinterpret_cast<char*>(&val), sizeof(double));
-				tmpval.push_back(val);
-			}
-			gs.classes.reco_angles[i][j] = tmpval;
-            gs.classes.reco_angles[j][i] = tmpval;
+            const double mx = get_field<double>(p);
+            gs.classes.max_reco_dist[i][j] = mx;
+            gs.classes.max_reco_dist[j][i] = mx;
+            const double rd = get_field<double>(p);
+            gs.classes.reco_dist[i][j] = rd;
+            gs.classes.reco_dist[j][i] = rd;
+            const int32_t valn = get_field<int32_t>(p);
+            std::vector<double>& ra = gs.classes.reco_angles[i][j];
+            ra.resize(valn);
+            if(valn>0) std::memcpy(ra.data(), p, sizeof(double)*valn);
+            p += sizeof(double)*valn;
+            gs.classes.reco_angles[j][i] = ra;
         }
     }
+    // recompiled by the next cost evaluation
+    gs.ctable = ObjClassTable();
 
     // models
-
-    int32_t num_models;
-    ifs.read(reinterpret_cast<char *>(&num_models), sizeof(int32_t));
-
+    const int32_t num_models = get_field<int32_t>(p);
+    gs.models.reserve(gs.models.size()+num_models);
     for(int32_t i=0; i<num_models; ++i)
     {
-        char name[256];
-        int32_t cid, oid;
+        const int32_t str_sz = get_field<int32_t>(p);
+        std::string name(p, str_sz);
+        p += str_sz;
+        const int32_t cid = get_field<int32_t>(p);
+        const int32_t oid = get_field<int32_t>(p);
         Eigen::Vector3d radius;
-
-        int32_t str_sz;
-        ifs.read(reinterpret_cast<char *>(&str_sz), sizeof(int32_t));
-        ifs.read(reinterpret_cast<char *>(name), sizeof(char)*str_sz);
-        name[str_sz] = 0;
-
-        ifs.read(reinterpret_cast<char *>(&cid), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char *>(&oid), sizeof(uint32_t));
-        ifs.read(reinterpret_cast<char *>(&radius(0,0)), sizeof(double));
-        ifs.read(reinterpret_cast<char *>(&radius(1,0)), sizeof(double));
-        ifs.read(reinterpret_cast<char *>(&radius(2,0)), sizeof(double));
-
-        // pose
-        double x, y, z, rot;
-        ifs.read(reinterpret_cast<char *>(&x), sizeof(double));
-        ifs.read(reinterpret_cast<char *>(&y), sizeof(double));
-        ifs.read(reinterpret_cast<char *>(&z), sizeof(double));
-        ifs.read(reinterpret_cast<char *>(&rot), sizeof(double));
-        GeomModel tmodel(name, oid, radius, gs.get_class(cid));
+        radius(0,0) = get_field<double>(p);
+        radius(1,0) = get_field<double>(p);
+        radius(2,0) = get_field<double>(p);
+        GeomModel tmodel(std::move(name), oid, radius, gs.get_class(cid));
         GeomPose& tp = tmodel.get_pose();
-        tp.pos(0,0) = x;
-        tp.pos(1,0) = y;
-        tp.pos(2,0) = z;
-        tp.rot = rot;
-        gs.insert(tmodel);
+        tp.pos(0,0) = get_field<double>(p);
+        tp.pos(1,0) = get_field<double>(p);
+        tp.pos(2,0) = get_field<double>(p);
+        tp.rot = get_field<double>(p);
+        gs.insert(std::move(tmodel));
     }
     return 0;
 }
 
-GeomSceneWriter::GeomSceneWriter(const GeomScene& _gs) : gs(_gs)
+int GeomSceneReader::read(std::istream& is)
+{
+    // the parsers work on buffers, so a stream is taken in whole
+    std::vector<char> buf((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    if(is.bad()) return -1;
+    return read(buf.data(), buf.size());
+}
+
+GeomSceneWriter::GeomSceneWriter(const GeomScene& _gs) : gs(_gs), version(2)
 {
 }
 
@@ -152,91 +220,487 @@ GeomSceneWriter::~GeomSceneWriter()
 
 int GeomSceneWriter::write(const char* fname)
 {
+    std::vector<char> buf;
+    serialize(buf);
     std::ofstream ofs(fname, std::ios::binary);
     if(!ofs.is_open()) return -1;
+    ofs.write(buf.data(), buf.size());
+    return ofs.good()?0:-1;
+}
 
-    // param_alpha
-    ofs.write(reinterpret_cast<const char *>(&gs.param_alpha), sizeof(double));
+int GeomSceneWriter::write(std::ostream& os)
+{
+    std::vector<char> buf;
+    serialize(buf);
+    os.write(buf.data(), buf.size());
+    return os.good()?0:-1;
+}
 
-    // seed
-    ofs.write(reinterpret_cast<const char *>(&gs.seed), sizeof(uint32_t));
+int GeomSceneWriter::write(const int fd)
+{
+    // for pipes and sockets too, so short writes are continued
+    std::vector<char> buf;
+    serialize(buf);
+    const char* p = buf.data();
+    std::size_t left = buf.size();
+    while(left>0)
+    {
+#if defined(_WIN32)
+        const int n = _write(fd, p, std::min<std::size_t>(left, INT_MAX));
+#else
+        const ssize_t n = ::write(fd, p, left);
+        if(n<0 && errno==EINTR) continue;
+#endif
+        if(n<=0) return -1;
+        p += n;
+        left -= n;
+    }
+    return 0;
+}
+
+template<typename T>
+static inline void put_field(char*& p, const T& val)
+{
+    std::memcpy(p, &val, sizeof(T));
+    p += sizeof(T);
+}
+
+std::size_t GeomSceneWriter::get_size_v1() const
+{
+    const int32_t num_classes = gs.get_num_classes();
+    std::size_t size = sizeof(double)+sizeof(uint32_t)+sizeof(int32_t);
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        size += sizeof(int32_t)+gs.get_class(i).name.size()+sizeof(ObjClass::GeomType)+sizeof(uint8_t)+sizeof(uint32_t);
+    }
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        for(int32_t j=i; j<num_classes; ++j)
+        {
+            size += 2*sizeof(double)+sizeof(int32_t)+sizeof(double)*gs.classes.reco_angles[i][j].size();
+        }
+    }
+    size += sizeof(int32_t);
+    for(const GeomModel& tmodel : gs.get_models())
+    {
+        size += sizeof(int32_t)+tmodel.get_name().size()+2*sizeof(uint32_t)+7*sizeof(double);
+    }
+    return size;
+}
+
+void GeomSceneWriter::serialize_v1(std::vector<char>& buf) const
+{
+    // sized exactly up front and filled in one pass, without copying the
+    // classes or the models
+    buf.resize(get_size_v1());
+    char* p = buf.data();
+
+    // param_alpha and seed
+    put_field(p, gs.param_alpha);
+    put_field(p, gs.seed);
 
     // classes
     const int32_t num_classes = gs.get_num_classes();
-    ofs.write(reinterpret_cast<const char *>(&num_classes), sizeof(int32_t));
+    put_field(p, num_classes);
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        const ObjClass& tcls = gs.get_class(i);
+        const int32_t str_sz = tcls.name.size();
+        put_field(p, str_sz);
+        std::memcpy(p, tcls.name.data(), str_sz);
+        p += str_sz;
+        put_field(p, tcls.type);
+        put_field(p, uint8_t(tcls.is_fixed));
+        put_field(p, int32_t(tcls.cid));
+    }
 
+    // class parameters
     for(int32_t i=0; i<num_classes; ++i)
     {
-        const ObjClass tcls = gs.get_class(i);
-        const ObjClass::GeomType type = tcls.type;
-        const uint8_t is_fixed = tcls.is_fixed;
+        for(int32_t j=i; j<num_classes; ++j)
+        {
+            put_field(p, gs.classes.max_reco_dist[i][j]);
+            put_field(p, gs.classes.reco_dist[i][j]);
+            const std::vector<double>& ra = gs.classes.reco_angles[i][j];
+            const int32_t valn = ra.size();
+            put_field(p, valn);
+            if(valn>0) std::memcpy(p, ra.data(), sizeof(double)*valn);
+            p += sizeof(double)*valn;
+        }
+    }
 
-        const int32_t str_sz = tcls.name.size();
-        ofs.write(reinterpret_cast<const char *>(&str_sz), sizeof(int32_t));
-        ofs.write(reinterpret_cast<const char *>(tcls.name.c_str()), sizeof(char)*str_sz);
+    // models
+    const int32_t num_models = gs.get_models().size();
+    put_field(p, num_models);
+    for(const GeomModel& tmodel : gs.get_models())
+    {
+        const int32_t str_sz = tmodel.get_name().size();
+        put_field(p, str_sz);
+        std::memcpy(p, tmodel.get_name().data(), str_sz);
+        p += str_sz;
+        put_field(p, tmodel.get_class_id());
+        put_field(p, int32_t(tmodel.get_object_id()));
+        const auto& radius = tmodel.get_radius();
+        put_field(p, radius(0,0));
+        put_field(p, radius(1,0));
+        put_field(p, radius(2,0));
+        const GeomPose& gp = tmodel.get_pose();
+        put_field(p, gp.pos(0,0));
+        put_field(p, gp.pos(1,0));
+        put_field(p, gp.pos(2,0));
+        put_field(p, gp.rot);
+    }
+}
 
-        ofs.write(reinterpret_cast<const char *>(&type), sizeof(ObjClass::GeomType));
-        ofs.write(reinterpret_cast<const char *>(&is_fixed), sizeof(uint8_t));
-        ofs.write(reinterpret_cast<const char *>(&tcls.cid), sizeof(uint32_t));
+// v2 records, copied in and out with memcpy so that the buffer needs no
+// alignment beyond the one of the pose section
+struct GeomClassRecord
+{
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint8_t type;
+    uint8_t is_fixed;
+    uint16_t pad;
+    int32_t cid;
+};
+
+struct GeomParamRecord
+{
+    double max_reco_dist;
+    double reco_dist;
+    uint32_t angle_index;
+    uint32_t num_angles;
+};
+
+struct GeomModelRecord
+{
+    double rx, ry, rz;
+    int32_t cid;
+    int32_t oid;
+    uint32_t name_offset;
+    uint32_t name_size;
+};
+
+static_assert(sizeof(GeomSceneHeader)==128, "v2 header must be 128 bytes");
+static_assert(sizeof(GeomClassRecord)==16, "v2 class record must be 16 bytes");
+static_assert(sizeof(GeomParamRecord)==24, "v2 parameter record must be 24 bytes");
+static_assert(sizeof(GeomModelRecord)==40, "v2 model record must be 40 bytes");
+static_assert(sizeof(GeomPoseRecord)==32, "v2 pose record must be 32 bytes");
+
+static inline uint64_t get_aligned(const uint64_t off, const uint64_t a)
+{
+    return ((off+a-1)/a)*a;
+}
+
+static inline int64_t get_num_params(const int64_t num_classes)
+{
+    return (num_classes*(num_classes+1))/2;
+}
+
+template<typename T>
+static inline T get_record(const char* data, const uint64_t offset, const int64_t i)
+{
+    T rec;
+    std::memcpy(&rec, data+offset+sizeof(T)*i, sizeof(T));
+    return rec;
+}
 
+static uint32_t get_crc_meta(const char* data, const GeomSceneHeader& hdr)
+{
+    // everything but the pose section, with the header crcs taken as 0
+    GeomSceneHeader thdr = hdr;
+    thdr.crc_meta = 0;
+    thdr.crc_poses = 0;
+    const uint64_t pose_end = hdr.pose_offset+sizeof(GeomPoseRecord)*hdr.num_models;
+    uint32_t crc = get_crc32(&thdr, sizeof(GeomSceneHeader));
+    crc = get_crc32(data+sizeof(GeomSceneHeader), hdr.pose_offset-sizeof(GeomSceneHeader), crc);
+    return get_crc32(data+pose_end, hdr.file_size-pose_end, crc);
+}
+
+static int get_header_v2(const char* data, const std::size_t size, const int32_t num_classes_old, GeomSceneHeader& hdr)
+{
+    // checks the header, the section bounds, every record and both crcs
+    if(size<sizeof(GeomSceneHeader)) return -1;
+    std::memcpy(&hdr, data, sizeof(GeomSceneHeader));
+    if(std::memcmp(hdr.magic, "GSCN", 4)!=0 || hdr.version!=2 || hdr.bom!=0xFEFF) return -1;
+    if(hdr.header_size!=sizeof(GeomSceneHeader) || hdr.file_size>size) return -1;
+    if(hdr.num_classes<0 || hdr.num_models<0 || (hdr.pose_offset%32)!=0) return -1;
+    const int64_t num_params = get_num_params(hdr.num_classes);
+    auto is_inside = [&](const uint64_t offset, const uint64_t n) {
+        return offset>=sizeof(GeomSceneHeader) && offset<=hdr.file_size && n<=(hdr.file_size-offset);
+    };
+    if(!is_inside(hdr.class_offset, sizeof(GeomClassRecord)*uint64_t(hdr.num_classes))
+            || !is_inside(hdr.param_offset, sizeof(GeomParamRecord)*uint64_t(num_params))
+            || !is_inside(hdr.angle_offset, sizeof(double)*uint64_t(hdr.num_angles))
+            || !is_inside(hdr.model_offset, sizeof(GeomModelRecord)*uint64_t(hdr.num_models))
+            || !is_inside(hdr.pose_offset, sizeof(GeomPoseRecord)*uint64_t(hdr.num_models))
+            || !is_inside(hdr.string_offset, 0))
+    {
+        return -1;
     }
+    const uint64_t string_size = hdr.file_size-hdr.string_offset;
+    for(int32_t i=0; i<hdr.num_classes; ++i)
+    {
+        const GeomClassRecord rec = get_record<GeomClassRecord>(data, hdr.class_offset, i);
+        if(rec.name_size>255 || rec.name_offset>string_size || rec.name_size>(string_size-rec.name_offset)) return -1;
+        if(rec.type>uint8_t(ObjClass::GeomType::Cuboid)) return -1;
+    }
+    for(int64_t k=0; k<num_params; ++k)
+    {
+        const GeomParamRecord rec = get_record<GeomParamRecord>(data, hdr.param_offset, k);
+        if(rec.angle_index>hdr.num_angles || rec.num_angles>(hdr.num_angles-rec.angle_index)) return -1;
+    }
+    for(int32_t i=0; i<hdr.num_models; ++i)
+    {
+        const GeomModelRecord rec = get_record<GeomModelRecord>(data, hdr.model_offset, i);
+        if(rec.cid<0 || rec.cid>=(num_classes_old+hdr.num_classes)) return -1;
+        if(rec.name_size>255 || rec.name_offset>string_size || rec.name_size>(string_size-rec.name_offset)) return -1;
+    }
+    if(get_crc32(data+hdr.pose_offset, sizeof(GeomPoseRecord)*hdr.num_models)!=hdr.crc_poses) return -1;
+    if(get_crc_meta(data, hdr)!=hdr.crc_meta) return -1;
+    return 0;
+}
+
+int GeomSceneReader::read_v2(const char* data, const std::size_t size)
+{
+    GeomSceneHeader hdr;
+    if(get_header_v2(data, size, gs.classes.get_num_classes(), hdr)!=0) return -1;
+    const char* strings = data+hdr.string_offset;
+    gs.param_alpha = hdr.param_alpha;
+    gs.set_seed(hdr.seed);
 
-    // now write the class parameters
+    // classes
+    const int32_t num_classes = hdr.num_classes;
+    std::vector<ObjClass> objclss;
+    objclss.reserve(num_classes);
     for(int32_t i=0; i<num_classes; ++i)
     {
-        for(int32_t j=i; j<num_classes; ++j)
+        const GeomClassRecord rec = get_record<GeomClassRecord>(data, hdr.class_offset, i);
+        objclss.emplace_back(std::string(strings+rec.name_offset, rec.name_size),
+                             ObjClass::GeomType(rec.type), rec.is_fixed, rec.cid);
+    }
+    if(gs.classes.insert_bulk(objclss)!=0) return -1;
+
+    // class parameters, upper triangle row by row
+    const double* angles = nullptr;
+    std::vector<double> angle_buf(hdr.num_angles);
+    if(hdr.num_angles>0)
+    {
+        std::memcpy(angle_buf.data(), data+hdr.angle_offset, sizeof(double)*hdr.num_angles);
+        angles = angle_buf.data();
+    }
+    int64_t k = 0;
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        for(int32_t j=i; j<num_classes; ++j, ++k)
         {
-            double val = gs.classes.max_reco_dist[i][j];
-            ofs.write(reinterpret_cast<char *>(&val), sizeof(double));
-            val = gs.classes.reco_dist[i][j];
-            ofs.write(reinterpret_cast<char *>(&val), sizeof(double));
-            auto& tmpval = gs.classes.reco_angles[i][j];
-			int32_t valn = tmpval.size();
-			ofs.write(reinterpret_cast<char*>(&valn), sizeof(int32_t));
-			for(int32_t k=0; k<valn; ++k)
-			{
-				val = tmpval[k];
-				ofs.write(reinterpret_cast<char*>(&val), sizeof(double));
-			}
+            const GeomParamRecord rec = get_record<GeomParamRecord>(data, hdr.param_offset, k);
+            gs.classes.max_reco_dist[i][j] = rec.max_reco_dist;
+            gs.classes.max_reco_dist[j][i] = rec.max_reco_dist;
+            gs.classes.reco_dist[i][j] = rec.reco_dist;
+            gs.classes.reco_dist[j][i] = rec.reco_dist;
+            gs.classes.reco_angles[i][j].assign(angles+rec.angle_index, angles+rec.angle_index+rec.num_angles);
+            gs.classes.reco_angles[j][i] = gs.classes.reco_angles[i][j];
         }
     }
+    // recompiled by the next cost evaluation
+    gs.ctable = ObjClassTable();
 
     // models
+    const int32_t num_models = hdr.num_models;
+    gs.models.reserve(gs.models.size()+num_models);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        const GeomModelRecord rec = get_record<GeomModelRecord>(data, hdr.model_offset, i);
+        const GeomPoseRecord prec = get_record<GeomPoseRecord>(data, hdr.pose_offset, i);
+        Eigen::Vector3d radius;
+        radius(0,0) = rec.rx;
+        radius(1,0) = rec.ry;
+        radius(2,0) = rec.rz;
+        GeomModel tmodel(std::string(strings+rec.name_offset, rec.name_size), rec.oid, radius, gs.get_class(rec.cid));
+        GeomPose& tp = tmodel.get_pose();
+        tp.pos(0,0) = prec.x;
+        tp.pos(1,0) = prec.y;
+        tp.pos(2,0) = prec.z;
+        tp.rot = prec.rot;
+        gs.insert(std::move(tmodel));
+    }
+    return 0;
+}
 
+const GeomPoseRecord* GeomSceneReader::get_pose_records(const char* data, const std::size_t size, int32_t& num_models)
+{
+    // the pose array of a checked v2 buffer, used in place
+    GeomSceneHeader hdr;
+    num_models = 0;
+    if(data==nullptr || get_header_v2(data, size, 0, hdr)!=0) return nullptr;
+    if((reinterpret_cast<uintptr_t>(data+hdr.pose_offset)%alignof(GeomPoseRecord))!=0) return nullptr;
+    num_models = hdr.num_models;
+    return reinterpret_cast<const GeomPoseRecord*>(data+hdr.pose_offset);
+}
+
+static void get_layout_v2(const GeomScene& gs, GeomSceneHeader& hdr)
+{
+    // section offsets and sizes of gs in the v2 layout
+    std::memset(&hdr, 0, sizeof(GeomSceneHeader));
+    const int32_t num_classes = gs.get_num_classes();
     const int32_t num_models = gs.get_models().size();
-    ofs.write(reinterpret_cast<const char *>(&num_models), sizeof(int32_t));
+    const int64_t num_params = get_num_params(num_classes);
+    const ObjClassSet& classes = gs.get_classes();
+    uint64_t num_angles = 0;
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        for(int32_t j=i; j<num_classes; ++j) num_angles += classes.get_reco_angles(i, j).size();
+    }
+    uint64_t string_size = 0;
+    for(int32_t i=0; i<num_classes; ++i) string_size += gs.get_class(i).name.size();
+    for(const GeomModel& tmodel : gs.get_models()) string_size += tmodel.get_name().size();
+    hdr.num_classes = num_classes;
+    hdr.num_models = num_models;
+    hdr.num_angles = num_angles;
+    hdr.class_offset = sizeof(GeomSceneHeader);
+    hdr.param_offset = get_aligned(hdr.class_offset+sizeof(GeomClassRecord)*num_classes, 8);
+    hdr.angle_offset = hdr.param_offset+sizeof(GeomParamRecord)*num_params;
+    hdr.model_offset = hdr.angle_offset+sizeof(double)*num_angles;
+    hdr.pose_offset = get_aligned(hdr.model_offset+sizeof(GeomModelRecord)*num_models, 32);
+    hdr.string_offset = hdr.pose_offset+sizeof(GeomPoseRecord)*num_models;
+    hdr.file_size = hdr.string_offset+string_size;
+}
 
-    for(int32_t i=0; i<num_models; ++i)
+std::size_t GeomSceneWriter::get_size() const
+{
+    if(version==1) return get_size_v1();
+    GeomSceneHeader hdr;
+    get_layout_v2(gs, hdr);
+    return hdr.file_size;
+}
+
+void GeomSceneWriter::serialize(std::vector<char>& buf) const
+{
+    if(version==1)
     {
-        const GeomModel tmodel = gs.get_model(i);
-        const int32_t cid = tmodel.get_class_id();
-        const int32_t oid = tmodel.get_object_id();
+        serialize_v1(buf);
+        return;
+    }
+    serialize_v2(buf);
+}
 
-        const auto& radius = tmodel.get_radius();
+void GeomSceneWriter::serialize_v2(std::vector<char>& buf) const
+{
+    GeomSceneHeader hdr;
+    get_layout_v2(gs, hdr);
+    std::memcpy(hdr.magic, "GSCN", 4);
+    hdr.version = 2;
+    hdr.bom = 0xFEFF;
+    hdr.header_size = sizeof(GeomSceneHeader);
+    hdr.param_alpha = gs.param_alpha;
+    hdr.seed = gs.seed;
+    buf.assign(hdr.file_size, 0);
+    char* data = buf.data();
+    char* strings = data+hdr.string_offset;
+    uint32_t string_pos = 0;
 
-        const int32_t str_sz = tmodel.get_name().size();
-        ofs.write(reinterpret_cast<const char *>(&str_sz), sizeof(int32_t));
-        ofs.write(reinterpret_cast<const char *>(tmodel.get_name().c_str()), sizeof(char)*str_sz);
+    // classes
+    const int32_t num_classes = hdr.num_classes;
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        const ObjClass& tcls = gs.get_class(i);
+        GeomClassRecord rec;
+        rec.name_offset = string_pos;
+        rec.name_size = tcls.name.size();
+        rec.type = uint8_t(tcls.type);
+        rec.is_fixed = tcls.is_fixed;
+        rec.pad = 0;
+        rec.cid = tcls.cid;
+        std::memcpy(data+hdr.class_offset+sizeof(GeomClassRecord)*i, &rec, sizeof(GeomClassRecord));
+        std::memcpy(strings+string_pos, tcls.name.data(), rec.name_size);
+        string_pos += rec.name_size;
+    }
 
-        ofs.write(reinterpret_cast<const char *>(&cid), sizeof(uint32_t));
-        ofs.write(reinterpret_cast<const char *>(&oid), sizeof(uint32_t));
-        ofs.write(reinterpret_cast<const char *>(&radius(0,0)), sizeof(double));
-        ofs.write(reinterpret_cast<const char *>(&radius(1,0)), sizeof(double));
-        ofs.write(reinterpret_cast<const char *>(&radius(2,0)), sizeof(double));
+    // class parameters
+    uint32_t angle_pos = 0;
+    int64_t k = 0;
+    for(int32_t i=0; i<num_classes; ++i)
+    {
+        for(int32_t j=i; j<num_classes; ++j, ++k)
+        {
+            const std::vector<double>& ra = gs.classes.reco_angles[i][j];
+            GeomParamRecord rec;
+            rec.max_reco_dist = gs.classes.max_reco_dist[i][j];
+            rec.reco_dist = gs.classes.reco_dist[i][j];
+            rec.angle_index = angle_pos;
+            rec.num_angles = ra.size();
+            std::memcpy(data+hdr.param_offset+sizeof(GeomParamRecord)*k, &rec, sizeof(GeomParamRecord));
+            if(!ra.empty()) std::memcpy(data+hdr.angle_offset+sizeof(double)*angle_pos, ra.data(), sizeof(double)*ra.size());
+            angle_pos += ra.size();
+        }
+    }
 
-        // pose
+    // models and poses
+    const int32_t num_models = hdr.num_models;
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        const GeomModel& tmodel = gs.get_model(i);
+        const auto& radius = tmodel.get_radius();
+        GeomModelRecord rec;
+        rec.rx = radius(0,0);
+        rec.ry = radius(1,0);
+        rec.rz = radius(2,0);
+        rec.cid = tmodel.get_class_id();
+        rec.oid = tmodel.get_object_id();
+        rec.name_offset = string_pos;
+        rec.name_size = tmodel.get_name().size();
+        std::memcpy(data+hdr.model_offset+sizeof(GeomModelRecord)*i, &rec, sizeof(GeomModelRecord));
+        std::memcpy(strings+string_pos, tmodel.get_name().data(), rec.name_size);
+        string_pos += rec.name_size;
         const GeomPose& gp = tmodel.get_pose();
-        const double x = gp.pos(0,0);
-        const double y = gp.pos(1,0);
-        const double z = gp.pos(2,0);
-        const double rot = gp.rot;
+        const GeomPoseRecord prec = {gp.pos(0,0), gp.pos(1,0), gp.pos(2,0), gp.rot};
+        std::memcpy(data+hdr.pose_offset+sizeof(GeomPoseRecord)*i, &prec, sizeof(GeomPoseRecord));
+    }
+    hdr.crc_poses = get_crc32(data+hdr.pose_offset, sizeof(GeomPoseRecord)*num_models);
+    hdr.crc_meta = get_crc_meta(data, hdr);
+    std::memcpy(data, &hdr, sizeof(GeomSceneHeader));
+}
 
-        ofs.write(reinterpret_cast<const char *>(&x), sizeof(double));
-        ofs.write(reinterpret_cast<const char *>(&y), sizeof(double));
-        ofs.write(reinterpret_cast<const char *>(&z), sizeof(double));
-        ofs.write(reinterpret_cast<const char *>(&rot), sizeof(double));
+int GeomSceneWriter::write_poses(const char* fname)
+{
+    // rewrites only the pose section and its crc of an existing v2 file
+    // of this scene: the file is checked in full first, and everything but
+    // the header and the poses has to be what this scene would write
+    std::fstream fs(fname, std::ios::in|std::ios::out|std::ios::binary);
+    if(!fs.is_open()) return -1;
+    const std::vector<char> data((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    GeomSceneHeader hdr;
+    if(get_header_v2(data.data(), data.size(), 0, hdr)!=0 || hdr.file_size!=data.size()) return -1;
+    std::vector<char> buf;
+    serialize_v2(buf);
+    GeomSceneHeader thdr;
+    std::memcpy(&thdr, buf.data(), sizeof(GeomSceneHeader));
+    if(thdr.file_size!=hdr.file_size || thdr.num_classes!=hdr.num_classes || thdr.num_models!=hdr.num_models
+            || thdr.num_angles!=hdr.num_angles || thdr.pose_offset!=hdr.pose_offset)
+    {
+        return -1;
     }
-    return 0;
+    const int32_t num_models = hdr.num_models;
+    const uint64_t pose_end = hdr.pose_offset+sizeof(GeomPoseRecord)*uint64_t(num_models);
+    if(!std::equal(data.begin()+sizeof(GeomSceneHeader), data.begin()+hdr.pose_offset, buf.begin()+sizeof(GeomSceneHeader))
+            || !std::equal(data.begin()+pose_end, data.end(), buf.begin()+pose_end))
+    {
+        return -1;
+    }
+    std::vector<GeomPoseRecord> poses(num_models);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        const GeomPose& gp = gs.get_model(i).get_pose();
+        poses[i] = {gp.pos(0,0), gp.pos(1,0), gp.pos(2,0), gp.rot};
+    }
+    hdr.crc_poses = get_crc32(poses.data(), sizeof(GeomPoseRecord)*num_models);
+    fs.clear();
+    fs.seekp(hdr.pose_offset);
+    fs.write(reinterpret_cast<const char *>(poses.data()), sizeof(GeomPoseRecord)*num_models);
+    fs.seekp(offsetof(GeomSceneHeader, crc_poses));
+    fs.write(reinterpret_cast<const char *>(&hdr.crc_poses), sizeof(uint32_t));
+    return fs.good()?0:-1;
 }
 
 }
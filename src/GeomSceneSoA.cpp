@@ -0,0 +1,111 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSceneSoA.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomSceneSoA.
+ */
+
+#include "../include/GeomSceneSoA.h"
+#include "../include/ObjClass.h"
+#include "../include/GeomKernels.h"
+
+namespace simugeom
+{
+
+GeomSceneSoA::GeomSceneSoA()
+{
+}
+
+GeomSceneSoA::~GeomSceneSoA()
+{
+}
+
+void GeomSceneSoA::build(const std::vector<GeomModel>& models, const ObjClassSet& classes)
+{
+    const int32_t num_models = models.size();
+    x.resize(num_models);
+    y.resize(num_models);
+    rot.resize(num_models);
+    rx.resize(num_models);
+    ry.resize(num_models);
+    radmax.resize(num_models);
+    cr.resize(num_models);
+    sr.resize(num_models);
+    rself.resize(num_models);
+    cid.resize(num_models);
+    type.resize(num_models);
+    is_fixed.assign((num_models+63)/64, 0);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        set(i, models[i], classes.get_class(models[i].get_class_id()));
+    }
+    movable.clear();
+    fixed.clear();
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        if(get_is_fixed(i)) fixed.push_back(i);
+        else movable.push_back(i);
+    }
+}
+
+void GeomSceneSoA::sync(const std::vector<GeomModel>& models, const ObjClassSet& classes, std::vector<int>& changed)
+{
+    // copies back the models whose pose or radius changed since the last sync
+    changed.clear();
+    const int32_t num_models = models.size();
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        const GeomPose& pose = models[i].get_pose();
+        const auto& rad = models[i].get_radius();
+        if(x[i]!=pose.pos(0,0) || y[i]!=pose.pos(1,0) || rot[i]!=pose.rot || rx[i]!=rad(0,0) || ry[i]!=rad(1,0))
+        {
+            set(i, models[i], classes.get_class(models[i].get_class_id()));
+            changed.push_back(i);
+        }
+    }
+}
+
+void GeomSceneSoA::set(const int i, const GeomModel& model, const ObjClass& cls)
+{
+    const auto& rad = model.get_radius();
+    rx[i] = rad(0,0);
+    ry[i] = rad(1,0);
+    radmax[i] = model.get_bb_radius_max();
+    cid[i] = cls.cid;
+    type[i] = cls.type;
+    if(cls.is_fixed) is_fixed[i>>6] |= (uint64_t(1)<<(i&63));
+    else is_fixed[i>>6] &= ~(uint64_t(1)<<(i&63));
+    set_pose(i, model.get_pose());
+}
+
+void GeomSceneSoA::set_pose(const int i, const GeomPose& pose)
+{
+    x[i] = pose.pos(0,0);
+    y[i] = pose.pos(1,0);
+    rot[i] = pose.rot;
+    cr[i] = std::cos(rot[i]);
+    sr[i] = std::sin(rot[i]);
+    rself[i] = get_bb_radius_kernel(type[i], rx[i], ry[i], x[i], y[i], cr[i], sr[i], x[i], y[i]);
+}
+
+}
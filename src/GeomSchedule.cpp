@@ -0,0 +1,146 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSchedule.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomSchedule.
+ */
+
+#include "../include/GeomSchedule.h"
+#include <cmath>
+#include <algorithm>
+
+namespace simugeom
+{
+
+// whether a checkpointed state is one of the given kind and size, with the
+// given parameters following the kind
+static bool is_state_of(const std::vector<double>& state, const GeomSchedule::Kind kind, const std::size_t size,
+                        const std::vector<double>& params)
+{
+    return state.size()==size && state[0]==double(kind) && std::equal(params.begin(), params.end(), state.begin()+1);
+}
+
+void GeomScheduleClassic::get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step)
+{
+    const auto d = ((double)(iter-1))/maxiters;
+    const auto d2 = d*d;
+    // const auto beta2 = (1.-d);
+    // const auto beta2 = (1.-d2);
+    step = (1.-d+d2*(1-d2));
+    // const auto beta2 = (1.-d2-d2*(d-d2));
+    // other functions
+    // (1-x+x^2-x^4)
+    // (1-x^2-x^3+x^4)
+    temp = 1.0/(double(iter)*iter);
+}
+
+GeomScheduleGeometric::GeomScheduleGeometric(const double _temp_begin, const double _temp_end,
+        const double _step_begin, const double _step_end) : temp_begin(_temp_begin), temp_end(_temp_end),
+    step_begin(_step_begin), step_end(_step_end)
+{
+}
+
+void GeomScheduleGeometric::get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step)
+{
+    const double d = (maxiters>1)?(double(iter-1)/(maxiters-1)):1.0;
+    temp = temp_begin*std::pow(temp_end/temp_begin, d);
+    step = step_begin*std::pow(step_end/step_begin, d);
+}
+
+void GeomScheduleGeometric::get_state(std::vector<double>& state) const
+{
+    state.assign({double(get_kind()), temp_begin, temp_end, step_begin, step_end});
+}
+
+int GeomScheduleGeometric::set_state(const std::vector<double>& state)
+{
+    // nothing changes during a run, a resume only checks the parameters
+    return is_state_of(state, get_kind(), 5, {temp_begin, temp_end, step_begin, step_end})?0:-1;
+}
+
+GeomScheduleAdaptive::GeomScheduleAdaptive(const double _target_accept, const double _target_uphill_begin,
+        const double _target_uphill_end, const double _gain) : target_accept(_target_accept),
+    target_uphill_begin(_target_uphill_begin), target_uphill_end(_target_uphill_end), gain(_gain),
+    step_min(0.01), step_max(1.0), log_temp(0.0), log_step(0.0), progress(0.0), is_calibrated(false)
+{
+}
+
+void GeomScheduleAdaptive::begin(const int32_t maxiters)
+{
+    (void)maxiters;
+    log_temp = 0.0;
+    log_step = std::log(step_max);
+    progress = 0.0;
+    is_calibrated = false;
+}
+
+void GeomScheduleAdaptive::get_params(const int32_t iter, const int32_t maxiters, double& temp, double& step)
+{
+    progress = (maxiters>1)?(double(iter-1)/(maxiters-1)):1.0;
+    temp = std::exp(log_temp);
+    step = std::exp(log_step);
+}
+
+void GeomScheduleAdaptive::update(const GeomScheduleStats& stats)
+{
+    if(stats.num_proposed==0) return;
+    // larger steps are accepted less often
+    const double rate = double(stats.num_accepted)/stats.num_proposed;
+    log_step += gain*(rate-target_accept)/target_accept;
+    log_step = std::min(std::max(log_step, std::log(step_min)), std::log(step_max));
+    if(stats.num_uphill==0) return;
+    const double target = target_uphill_begin*std::pow(target_uphill_end/target_uphill_begin, progress);
+    if(!is_calibrated)
+    {
+        // exp(-mean/temp) = target for the mean uphill move
+        const double mean = stats.sum_uphill/stats.num_uphill;
+        if(mean>0.0) log_temp = std::log(-mean/std::log(target));
+        is_calibrated = true;
+        return;
+    }
+    // relative error of the uphill acceptance, limited to a factor e per
+    // iteration
+    const double rate_uphill = double(stats.num_uphill_accepted)/stats.num_uphill;
+    log_temp += gain*std::min(std::max((target-rate_uphill)/target, -1.0), 1.0);
+}
+
+void GeomScheduleAdaptive::get_state(std::vector<double>& state) const
+{
+    state.assign({double(get_kind()), target_accept, target_uphill_begin, target_uphill_end, gain, step_min, step_max,
+                  log_temp, log_step, progress, is_calibrated?1.0:0.0});
+}
+
+int GeomScheduleAdaptive::set_state(const std::vector<double>& state)
+{
+    if(!is_state_of(state, get_kind(), 11, {target_accept, target_uphill_begin, target_uphill_end, gain, step_min, step_max}))
+    {
+        return -1;
+    }
+    log_temp = state[7];
+    log_step = state[8];
+    progress = state[9];
+    is_calibrated = (state[10]!=0.0);
+    return 0;
+}
+
+}
@@ -0,0 +1,165 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomSpatialGrid.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomSpatialGrid.
+ */
+
+#include "../include/GeomSpatialGrid.h"
+#include <cmath>
+#include <algorithm>
+
+namespace simugeom
+{
+
+GeomSpatialGrid::GeomSpatialGrid() : cell_size(1.0), bucket_mask(0)
+{
+}
+
+GeomSpatialGrid::~GeomSpatialGrid()
+{
+}
+
+int32_t GeomSpatialGrid::get_cell(const double v) const
+{
+    return static_cast<int32_t>(std::floor(v/cell_size));
+}
+
+uint32_t GeomSpatialGrid::get_bucket(const int32_t ix, const int32_t iy) const
+{
+    return ((static_cast<uint32_t>(ix)*73856093u)^(static_cast<uint32_t>(iy)*19349663u))&bucket_mask;
+}
+
+void GeomSpatialGrid::build(const GeomSceneSoA& soa)
+{
+    const int32_t num_models = soa.size();
+    // each model is stored as the disc bounding all its bb radii,
+    // cells are sized to hold a typical disc
+    double mean_rad = 0.0;
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        mean_rad += soa.radmax[i];
+    }
+    cell_size = (num_models>0 && mean_rad>0.0)?(2.0*mean_rad/num_models):1.0;
+
+    uint32_t num_buckets = 16;
+    while(num_buckets<2*static_cast<uint32_t>(num_models)) num_buckets <<= 1;
+    bucket_mask = num_buckets-1;
+    buckets.assign(num_buckets, std::vector<int>());
+
+    entries.resize(num_models);
+    for(int32_t i=0; i<num_models; ++i)
+    {
+        Entry& e = entries[i];
+        e.x = soa.x[i];
+        e.y = soa.y[i];
+        e.rad = soa.radmax[i];
+        insert_entry(i);
+    }
+}
+
+void GeomSpatialGrid::update(const GeomSceneSoA& soa, const int oid)
+{
+    Entry& e = entries[oid];
+    e.x = soa.x[oid];
+    e.y = soa.y[oid];
+    e.rad = soa.radmax[oid];
+    const int32_t ix0 = get_cell(e.x-e.rad), iy0 = get_cell(e.y-e.rad);
+    const int32_t ix1 = get_cell(e.x+e.rad), iy1 = get_cell(e.y+e.rad);
+    if(ix0==e.ix0 && iy0==e.iy0 && ix1==e.ix1 && iy1==e.iy1) return;
+    remove_entry(oid);
+    insert_entry(oid);
+}
+
+void GeomSpatialGrid::insert_entry(const int oid)
+{
+    Entry& e = entries[oid];
+    e.ix0 = get_cell(e.x-e.rad);
+    e.iy0 = get_cell(e.y-e.rad);
+    e.ix1 = get_cell(e.x+e.rad);
+    e.iy1 = get_cell(e.y+e.rad);
+    for(int32_t iy=e.iy0; iy<=e.iy1; ++iy)
+    {
+        for(int32_t ix=e.ix0; ix<=e.ix1; ++ix)
+        {
+            // keep buckets sorted so that queries do not depend on the update history
+            std::vector<int>& b = buckets[get_bucket(ix, iy)];
+            const auto it = std::lower_bound(b.begin(), b.end(), oid);
+            if(it==b.end() || *it!=oid) b.insert(it, oid);
+        }
+    }
+}
+
+void GeomSpatialGrid::remove_entry(const int oid)
+{
+    const Entry& e = entries[oid];
+    for(int32_t iy=e.iy0; iy<=e.iy1; ++iy)
+    {
+        for(int32_t ix=e.ix0; ix<=e.ix1; ++ix)
+        {
+            std::vector<int>& b = buckets[get_bucket(ix, iy)];
+            const auto it = std::lower_bound(b.begin(), b.end(), oid);
+            if(it!=b.end() && *it==oid) b.erase(it);
+        }
+    }
+}
+
+void GeomSpatialGrid::query(const double x, const double y, const double r, std::vector<int>& oids) const
+{
+    // returns every model whose disc overlaps the disc (x, y, r)
+    oids.clear();
+    const int32_t num_entries = entries.size();
+    const int32_t qx0 = get_cell(x-r), qy0 = get_cell(y-r);
+    const int32_t qx1 = get_cell(x+r), qy1 = get_cell(y+r);
+    const double num_cells = (double(qx1)-qx0+1)*(double(qy1)-qy0+1);
+    if(num_cells>=num_entries)
+    {
+        // too wide a query, a linear scan is cheaper
+        for(int32_t i=0; i<num_entries; ++i)
+        {
+            const Entry& e = entries[i];
+            const double dx = e.x-x, dy = e.y-y, rr = e.rad+r;
+            if(dx*dx+dy*dy<=rr*rr) oids.push_back(i);
+        }
+        return;
+    }
+    for(int32_t iy=qy0; iy<=qy1; ++iy)
+    {
+        for(int32_t ix=qx0; ix<=qx1; ++ix)
+        {
+            const std::vector<int>& b = buckets[get_bucket(ix, iy)];
+            for(const int oid : b)
+            {
+                const Entry& e = entries[oid];
+                // report each model only from the first cell shared with the query,
+                // this also drops hash collisions from foreign cells
+                if(ix!=std::max(e.ix0, qx0) || iy!=std::max(e.iy0, qy0)) continue;
+                if(ix>e.ix1 || iy>e.iy1) continue;
+                const double dx = e.x-x, dy = e.y-y, rr = e.rad+r;
+                if(dx*dx+dy*dy<=rr*rr) oids.push_back(oid);
+            }
+        }
+    }
+}
+
+}
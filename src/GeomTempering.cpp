@@ -0,0 +1,213 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomTempering.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomTempering.
+ */
+
+#include "../include/GeomTempering.h"
+#include <omp.h>
+#include <limits>
+#include <meshlib.h>
+#include <algorithm>
+#include <cmath>
+
+namespace simugeom
+{
+
+GeomTempering::GeomTempering(GeomScene& _gsn, const int32_t _num_replicas) : gsn(_gsn),
+    tmin(1e-3), tmax(1.0), cost_best(std::numeric_limits<double>::max()),
+    num_replicas(_num_replicas), swap_interval(1), curr_iter(-1), maxiters(500),
+    num_swaps(0), num_swaps_accepted(0), pose_best(gsn.get_models().size()), trace(nullptr)
+{
+}
+
+GeomTempering::~GeomTempering()
+{
+}
+
+void GeomTempering::set_temperatures(const double _tmin, const double _tmax)
+{
+    tmin = _tmin;
+    tmax = _tmax;
+}
+
+void GeomTempering::set_maxiters(const int32_t _maxiters)
+{
+    maxiters = _maxiters;
+}
+
+void GeomTempering::upload_best_solution()
+{
+    const int num_models = gsn.get_models().size();
+    for(int i=0; i<num_models; ++i)
+    {
+        gsn.get_model(i).pose = pose_best[i];
+    }
+}
+
+void GeomTempering::initialise()
+{
+    // geometric temperature ladder, every replica starts from its own
+    // scatter with its own random stream
+    const int32_t r_max = std::max(num_replicas-1, 1);
+    const int num_models = gsn.get_models().size();
+    temps.resize(num_replicas);
+    slot.resize(num_replicas);
+    level.resize(num_replicas);
+    costs.resize(num_replicas);
+    bests.resize(num_replicas);
+    pose_bests.resize(num_replicas);
+    replicas.assign(num_replicas, gsn);
+    curr_iter = 0;
+    num_swaps = 0;
+    num_swaps_accepted = 0;
+    cost_best = std::numeric_limits<double>::max();
+    for(int32_t r=0; r<num_replicas; ++r)
+    {
+        temps[r] = tmin*std::pow(tmax/tmin, double(r)/r_max);
+        slot[r] = r;
+        level[r] = r;
+        replicas[r].set_seed(gsn.rng());
+        replicas[r].scatter();
+        costs[r] = replicas[r].get_cost_total();
+        bests[r] = costs[r];
+        pose_bests[r].resize(num_models);
+        for(int i=0; i<num_models; ++i) pose_bests[r][i] = replicas[r].get_model(i).pose;
+        if(bests[r]<cost_best)
+        {
+            cost_best = bests[r];
+            pose_best = pose_bests[r];
+        }
+    }
+}
+
+void GeomTempering::sweep(const int32_t r)
+{
+    // metropolis epochs of one replica at its current temperature, the
+    // hotter replicas also take the larger steps
+    GeomScene& s = replicas[r];
+    const int32_t t = level[r];
+    const double temp = temps[t];
+    const double scale = 0.1+0.9*double(t)/std::max(num_replicas-1, 1);
+    const double sigmpos = 0.5*scale*std::sqrt(s.bbox.rad(0,0)*s.bbox.rad(0,0)+s.bbox.rad(1,0)*s.bbox.rad(1,0));
+    const double sigmrot = 0.5*scale*MESH_TWOPI;
+    std::vector<int> seq(s.get_movable_ids().begin(), s.get_movable_ids().end());
+    for(int32_t e=0; e<swap_interval; ++e)
+    {
+        const uint32_t iter = uint32_t(curr_iter)*swap_interval+e;
+        s.shuffle(seq, iter);
+        for(const int oid : seq)
+        {
+            GeomModel& tmodel = s.get_model(oid);
+            tmodel.propose_perturb(1, sigmpos, sigmrot, s, iter);
+            const double cost_local_old = s.get_cost_local(oid);
+            std::swap(tmodel.pose, tmodel.proposed_poses[0]);
+            const double dcost = s.get_cost_local(oid)-cost_local_old;
+            if((dcost<0.0) || (std::exp(-dcost/temp)>0.5*(s.get_uniform(GeomRngDomain::Accept, oid, iter, 0)+1.0)))
+            {
+                costs[r] += dcost;
+                s.commit_cost_local(oid);
+                if(costs[r]<bests[r])
+                {
+                    bests[r] = costs[r];
+                    const int num_models = s.get_models().size();
+                    for(int i=0; i<num_models; ++i) pose_bests[r][i] = s.get_model(i).pose;
+                }
+            }
+            else
+            {
+                std::swap(tmodel.pose, tmodel.proposed_poses[0]);
+                s.rollback_cost_local(oid);
+            }
+        }
+    }
+}
+
+void GeomTempering::exchange()
+{
+    // swap the temperatures of adjacent replicas, alternating between the
+    // even and the odd pairs of the ladder
+    for(int32_t t=(curr_iter%2); (t+1)<num_replicas; t+=2)
+    {
+        const int32_t a = slot[t];
+        const int32_t b = slot[t+1];
+        const double lp = (costs[a]-costs[b])*(1.0/temps[t]-1.0/temps[t+1]);
+        ++num_swaps;
+        // keyed by the lower ladder rung of the pair and the round
+        if((lp>=0.0) || (std::log(0.5*(gsn.get_uniform(GeomRngDomain::Exchange, t, curr_iter, 0)+1.0))<lp))
+        {
+            std::swap(slot[t], slot[t+1]);
+            std::swap(level[a], level[b]);
+            ++num_swaps_accepted;
+        }
+    }
+}
+
+void GeomTempering::iterate()
+{
+    ++curr_iter;
+    #pragma omp parallel for schedule(dynamic)
+    for(int32_t r=0; r<num_replicas; ++r)
+    {
+        sweep(r);
+    }
+    for(int32_t r=0; r<num_replicas; ++r)
+    {
+        if(bests[r]<cost_best)
+        {
+            cost_best = bests[r];
+            pose_best = pose_bests[r];
+        }
+    }
+    exchange();
+}
+
+void GeomTempering::set_trace_sink(GeomTraceSink* _trace)
+{
+    trace = _trace;
+}
+
+void GeomTempering::solve()
+{
+    initialise();
+    if(trace)
+    {
+        trace->begin(maxiters);
+    }
+    for(int32_t i=0; i<maxiters; ++i)
+    {
+        iterate();
+        if(trace)
+        {
+            trace->push({i, costs[slot[0]], cost_best});
+        }
+    }
+    if(trace)
+    {
+        trace->end();
+    }
+    upload_best_solution();
+}
+
+}
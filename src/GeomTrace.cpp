@@ -0,0 +1,166 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomTrace.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomTrace.
+ */
+
+#include "../include/GeomTrace.h"
+#include <algorithm>
+
+namespace simugeom
+{
+
+GeomTraceTextSink::GeomTraceTextSink(const char* fname) : ofs(fname, std::ios::binary)
+{
+}
+
+void GeomTraceTextSink::push(const GeomTraceRecord& rec)
+{
+    if(ofs.is_open())
+    {
+        ofs<<rec.step<<" "<<rec.cost_new<<" "<<rec.cost_best<<"\n";
+    }
+}
+
+void GeomTraceTextSink::end()
+{
+    if(ofs.is_open()) ofs.flush();
+}
+
+static const char trace_magic[8] = {'G', 'T', 'R', 'A', 'C', 'E', '0', '1'};
+
+GeomTraceFileSink::GeomTraceFileSink(const char* fname, const std::size_t _block_size) :
+    ofs(fname, std::ios::binary|std::ios::trunc), block_size(std::max<std::size_t>(_block_size, 1))
+{
+    block.reserve(block_size);
+    if(ofs.is_open()) ofs.write(trace_magic, sizeof(trace_magic));
+}
+
+GeomTraceFileSink::~GeomTraceFileSink()
+{
+    end();
+}
+
+void GeomTraceFileSink::push(const GeomTraceRecord& rec)
+{
+    block.push_back(rec);
+    if(block.size()>=block_size) end();
+}
+
+void GeomTraceFileSink::end()
+{
+    // writes out the partial block
+    if(ofs.is_open() && !block.empty())
+    {
+        ofs.write(reinterpret_cast<const char *>(block.data()), sizeof(GeomTraceRecord)*block.size());
+        ofs.flush();
+    }
+    block.clear();
+}
+
+GeomTraceRingSink::GeomTraceRingSink(const std::size_t _capacity) : ring(std::max<std::size_t>(_capacity, 1)),
+    num_pushed(0)
+{
+}
+
+void GeomTraceRingSink::begin(const int64_t num_steps)
+{
+    (void)num_steps;
+    num_pushed = 0;
+}
+
+void GeomTraceRingSink::push(const GeomTraceRecord& rec)
+{
+    ring[num_pushed%ring.size()] = rec;
+    ++num_pushed;
+}
+
+void GeomTraceRingSink::get_records(std::vector<GeomTraceRecord>& recs) const
+{
+    const int64_t capacity = ring.size();
+    const int64_t n = std::min(num_pushed, capacity);
+    recs.resize(n);
+    for(int64_t i=0; i<n; ++i) recs[i] = ring[(num_pushed-n+i)%capacity];
+}
+
+GeomTraceDownsampleSink::GeomTraceDownsampleSink(const std::size_t _num_buckets) :
+    num_buckets(std::max<std::size_t>(_num_buckets, 1)), width(1)
+{
+    buckets.reserve(num_buckets);
+}
+
+void GeomTraceDownsampleSink::begin(const int64_t num_steps)
+{
+    // a known length gets the final width up front
+    buckets.clear();
+    width = std::max<int64_t>(1, (num_steps+num_buckets-1)/num_buckets);
+}
+
+static void merge_buckets(GeomTraceBucket& a, const GeomTraceBucket& b)
+{
+    a.num_steps += b.num_steps;
+    a.cost_new_min = std::min(a.cost_new_min, b.cost_new_min);
+    a.cost_new_max = std::max(a.cost_new_max, b.cost_new_max);
+    a.cost_best_min = std::min(a.cost_best_min, b.cost_best_min);
+    a.cost_best_max = std::max(a.cost_best_max, b.cost_best_max);
+}
+
+void GeomTraceDownsampleSink::push(const GeomTraceRecord& rec)
+{
+    // pairs of buckets are merged in place and the width doubles until the
+    // step falls into the last bucket or a free one
+    while(!buckets.empty() && (rec.step>=buckets.back().step_first+width) && (buckets.size()>=num_buckets))
+    {
+        const std::size_t n = buckets.size();
+        for(std::size_t i=0; i<n; i+=2)
+        {
+            GeomTraceBucket b = buckets[i];
+            if(i+1<n) merge_buckets(b, buckets[i+1]);
+            buckets[i/2] = b;
+        }
+        buckets.resize((n+1)/2);
+        width *= 2;
+    }
+    const GeomTraceBucket tb = {rec.step-rec.step%width, 1, rec.cost_new, rec.cost_new, rec.cost_best, rec.cost_best};
+    if(!buckets.empty() && (rec.step<buckets.back().step_first+width))
+    {
+        merge_buckets(buckets.back(), tb);
+        return;
+    }
+    buckets.push_back(tb);
+}
+
+int GeomTraceDownsampleSink::export_buckets(const char* fname) const
+{
+    std::ofstream ofs(fname, std::ios::binary);
+    if(!ofs.is_open()) return -1;
+    for(const GeomTraceBucket& b : buckets)
+    {
+        ofs<<b.step_first<<" "<<b.num_steps<<" "<<b.cost_new_min<<" "<<b.cost_new_max<<" "
+           <<b.cost_best_min<<" "<<b.cost_best_max<<"\n";
+    }
+    return ofs.good()?0:-1;
+}
+
+}
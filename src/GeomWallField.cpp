@@ -0,0 +1,156 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file GeomWallField.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of GeomWallField.
+ */
+
+#include "../include/GeomWallField.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace simugeom
+{
+
+static constexpr double field_slack = 1.0+1e-9;
+
+GeomWallField::GeomWallField()
+    : is_built(false), x0(0.0), y0(0.0), cell_size(1.0), nx(0), ny(0)
+{
+}
+
+GeomWallField::~GeomWallField()
+{
+}
+
+void GeomWallField::build(const GeomSceneSoA& soa, const AABB& bbox, const bool has_bbox)
+{
+    // covers the boundary and all fixed models, every cell keeps the fixed
+    // models that are nearest to at least one of its points
+    fixed = soa.fixed;
+    double xmin = std::numeric_limits<double>::max(), xmax = -xmin;
+    double ymin = xmin, ymax = xmax;
+    for(const int32_t i : fixed)
+    {
+        xmin = std::min(xmin, soa.x[i]);
+        xmax = std::max(xmax, soa.x[i]);
+        ymin = std::min(ymin, soa.y[i]);
+        ymax = std::max(ymax, soa.y[i]);
+    }
+    if(has_bbox)
+    {
+        xmin = std::min(xmin, bbox.pos(0,0)-bbox.rad(0,0));
+        xmax = std::max(xmax, bbox.pos(0,0)+bbox.rad(0,0));
+        ymin = std::min(ymin, bbox.pos(1,0)-bbox.rad(1,0));
+        ymax = std::max(ymax, bbox.pos(1,0)+bbox.rad(1,0));
+    }
+    const int32_t num_fixed = fixed.size();
+    is_built = true;
+    if(num_fixed==0)
+    {
+        nx = ny = 0;
+        offsets.assign(1, 0);
+        cands.clear();
+        return;
+    }
+    const double pad = 0.05*std::max(std::max(xmax-xmin, ymax-ymin), 1e-6);
+    xmin -= pad;
+    xmax += pad;
+    ymin -= pad;
+    ymax += pad;
+    const int32_t side = std::min(128, std::max(16, 4*int32_t(std::ceil(std::sqrt(double(num_fixed))))));
+    cell_size = std::max(xmax-xmin, ymax-ymin)/side;
+    x0 = xmin;
+    y0 = ymin;
+    nx = std::max(1, int32_t(std::ceil((xmax-xmin)/cell_size)));
+    ny = std::max(1, int32_t(std::ceil((ymax-ymin)/cell_size)));
+
+    offsets.resize(nx*ny+1);
+    cands.clear();
+    offsets[0] = 0;
+    std::vector<double> dmin(num_fixed);
+    for(int32_t cy=0; cy<ny; ++cy)
+    {
+        for(int32_t cx=0; cx<nx; ++cx)
+        {
+            const double cx0 = x0+cx*cell_size, cx1 = cx0+cell_size;
+            const double cy0 = y0+cy*cell_size, cy1 = cy0+cell_size;
+            double best = std::numeric_limits<double>::max();
+            for(int32_t f=0; f<num_fixed; ++f)
+            {
+                const double px = soa.x[fixed[f]], py = soa.y[fixed[f]];
+                // nearest and farthest points of the cell from the model
+                const double ex = std::max(std::max(cx0-px, px-cx1), 0.0);
+                const double ey = std::max(std::max(cy0-py, py-cy1), 0.0);
+                const double fx = std::max(std::abs(cx0-px), std::abs(cx1-px));
+                const double fy = std::max(std::abs(cy0-py), std::abs(cy1-py));
+                dmin[f] = std::sqrt(ex*ex+ey*ey);
+                best = std::min(best, std::sqrt(fx*fx+fy*fy));
+            }
+            for(int32_t f=0; f<num_fixed; ++f)
+            {
+                if(dmin[f]<=best*field_slack) cands.push_back(fixed[f]);
+            }
+            offsets[cy*nx+cx+1] = cands.size();
+        }
+    }
+}
+
+int GeomWallField::query_nearest(const GeomSceneSoA& soa, const int oid, double& dist, const bool is_scan) const
+{
+    // nearest fixed model to the centre of oid with the same tie breaking
+    // as a scan in oid order, which is also the fallback outside the field
+    const double x = soa.x[oid];
+    const double y = soa.y[oid];
+    const int32_t* it = fixed.data();
+    const int32_t* end = fixed.data()+fixed.size();
+    const double fcx = (x-x0)/cell_size;
+    const double fcy = (y-y0)/cell_size;
+    // a fixed oid is skipped below, so its own cell list may not hold the
+    // runner up; is_scan is for fixed models away from their baked poses
+    if(!is_scan && !soa.get_is_fixed(oid) && fcx>=0.0 && fcy>=0.0 && fcx<nx && fcy<ny)
+    {
+        const int32_t c = int32_t(fcy)*nx+int32_t(fcx);
+        it = cands.data()+offsets[c];
+        end = cands.data()+offsets[c+1];
+    }
+    int nearest = -1;
+    dist = std::numeric_limits<double>::max();
+    for(; it!=end; ++it)
+    {
+        const int j = *it;
+        if(j==oid) continue;
+        const double dx = x-soa.x[j];
+        const double dy = y-soa.y[j];
+        const double d = std::sqrt(dx*dx+dy*dy);
+        if(d<dist)
+        {
+            dist = d;
+            nearest = j;
+        }
+    }
+    return nearest;
+}
+
+}
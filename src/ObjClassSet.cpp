@@ -27,6 +27,7 @@
 
 #include "../include/ObjClassSet.h"
 #include "../include/ObjClass.h"
+#include "../include/ObjClassTable.h"
 #include <iostream>
 
 namespace simugeom
@@ -78,6 +79,76 @@ int ObjClassSet::insert(ObjClass&& objcls)
 	return 0;
 }
 
+int ObjClassSet::insert_bulk(const std::vector<ObjClass>& objclss)
+{
+    // all or nothing, growing every table row once for the whole batch
+    const int32_t old_num_classes = classes.size();
+    const int32_t num_classes = old_num_classes+objclss.size();
+    std::map<const std::string, int32_t> names;
+    for(const auto& objcls : objclss)
+    {
+        if(searcher.find(objcls.name)!=searcher.end()) return -1;
+        if(!names.emplace(objcls.name, 0).second) return -1;
+    }
+    reserve(num_classes);
+    for(const auto& objcls : objclss)
+    {
+        const int32_t cid = classes.size();
+        classes.push_back(objcls);
+        classes[cid].cid = cid; /* force set oid */
+        searcher.emplace(objcls.name, cid);
+    }
+    for(int32_t i=0; i<old_num_classes; ++i)
+    {
+        max_reco_dist[i].resize(num_classes, 0.0);
+        reco_dist[i].resize(num_classes, 0.0);
+        reco_angles[i].resize(num_classes);
+    }
+    max_reco_dist.resize(num_classes, std::vector<double>(num_classes, 0.0));
+    reco_dist.resize(num_classes, std::vector<double>(num_classes, 0.0));
+    reco_angles.resize(num_classes, std::vector<std::vector<double>>(num_classes));
+    return 0;
+}
+
+void ObjClassSet::reserve(const int32_t num_classes)
+{
+    // lets single inserts up to num_classes grow the rows in place
+    classes.reserve(num_classes);
+    max_reco_dist.reserve(num_classes);
+    reco_dist.reserve(num_classes);
+    reco_angles.reserve(num_classes);
+    const int32_t n = max_reco_dist.size();
+    for(int32_t i=0; i<n; ++i)
+    {
+        max_reco_dist[i].reserve(num_classes);
+        reco_dist[i].reserve(num_classes);
+        reco_angles[i].reserve(num_classes);
+    }
+}
+
+void ObjClassSet::compile(ObjClassTable& table) const
+{
+    // flattens the tables into contiguous arrays for the cost engine
+    const int32_t n = classes.size();
+    table.num_classes = n;
+    table.max_reco_dist.resize(n*n);
+    table.reco_dist.resize(n*n);
+    table.angle_offsets.resize(n*n+1);
+    table.angles.clear();
+    table.angle_offsets[0] = 0;
+    for(int32_t i=0; i<n; ++i)
+    {
+        for(int32_t j=0; j<n; ++j)
+        {
+            const int32_t p = i*n+j;
+            table.max_reco_dist[p] = max_reco_dist[i][j];
+            table.reco_dist[p] = reco_dist[i][j];
+            table.angles.insert(table.angles.end(), reco_angles[i][j].begin(), reco_angles[i][j].end());
+            table.angle_offsets[p+1] = table.angles.size();
+        }
+    }
+}
+
 double ObjClassSet::get_max_reco_dist(int32_t cid0, int32_t cid1) const
 {
     return max_reco_dist[cid0][cid1];
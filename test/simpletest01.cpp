@@ -0,0 +1,171 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file simpletest01.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of simpletest01.
+ */
+
+#include <GeomScene.h>
+#include <GeomModel.h>
+#include <GeomAnnealer.h>
+#include <GeomPhilox.h>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <meshlib.h>
+
+namespace sm = simugeom;
+
+// a room of four fixed walls with a seeded scatter of furniture
+static void make_room(sm::GeomScene& scn)
+{
+    const double wall_thickness = 1.0;
+    const double room_length = 6.0;
+    const double room_breadth = 4.0;
+    const double walls[4][5] = {{0.5*(room_length+wall_thickness), -0.5*wall_thickness, 0.5*MESH_PI, 0.5*(room_breadth+wall_thickness), 0.5*wall_thickness},
+                                {0.5*wall_thickness, 0.5*(room_breadth+wall_thickness), MESH_PI, 0.5*(room_length+wall_thickness), 0.5*wall_thickness},
+                                {-0.5*(room_length+wall_thickness), 0.5*wall_thickness, 1.5*MESH_PI, 0.5*(room_breadth+wall_thickness), 0.5*wall_thickness},
+                                {-0.5*wall_thickness, -0.5*(room_breadth+wall_thickness), 0.0, 0.5*(room_length+wall_thickness), 0.5*wall_thickness}};
+    for(int k=0; k<4; ++k)
+    {
+        sm::GeomPose pose;
+        Eigen::Vector3d rad;
+        pose.pos(0,0) = walls[k][0];
+        pose.pos(1,0) = walls[k][1];
+        pose.pos(2,0) = 0.0;
+        pose.rot = walls[k][2];
+        rad(0,0) = walls[k][3];
+        rad(1,0) = walls[k][4];
+        rad(2,0) = 1.0;
+        sm::GeomModel gm("wall_"+std::to_string(k), 0, rad, scn.get_class("wall"));
+        gm.set_pose(pose);
+        scn.insert(gm);
+    }
+    for(int k=0; k<12; ++k)
+    {
+        Eigen::Vector3d rad;
+        rad(0,0) = 0.2+0.05*(k%5);
+        rad(1,0) = 0.2+0.04*(k%7);
+        rad(2,0) = 1.0;
+        sm::GeomModel gm("obj_"+std::to_string(k), 0, rad, scn.get_class((k%3==0)?"table":"chair"));
+        scn.insert(gm);
+    }
+    Eigen::Vector3d pos, rad;
+    pos<<0.0, 0.0, 0.0;
+    rad<<0.5*room_length, 0.5*room_breadth, 1.0;
+    scn.set_boundary(sm::AABB(pos, rad));
+    scn.set_seed(2023);
+    scn.scatter();
+}
+
+int main()
+{
+    int num_errs = 0;
+
+    // philox4x32-10 known answers of random123, key (seed, domain)
+    {
+        const uint32_t keys[3][2] = {{0, 0}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+        const uint32_t ctrs[3][4] = {{0, 0, 0, 0}, {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                     {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+        const uint32_t outs[3][4] = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+                                     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+                                     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+        for(int i=0; i<3; ++i)
+        {
+            sm::GeomPhilox gen(keys[i][0]);
+            uint32_t out[4];
+            gen.get_block(sm::GeomRngDomain(keys[i][1]), ctrs[i], out);
+            if(std::memcmp(out, outs[i], sizeof(out))!=0)
+            {
+                std::cout<<"err: philox known answer "<<i<<"\n";
+                ++num_errs;
+            }
+        }
+    }
+
+    // the local and the cached cost paths against full evaluations
+    sm::ObjClassSet obj_types;
+    obj_types.insert("wall", sm::ObjClass::GeomType::Cuboid, true);
+    obj_types.insert("table", sm::ObjClass::GeomType::Ellipsoid);
+    obj_types.insert("chair", sm::ObjClass::GeomType::Cuboid);
+    {
+        auto& mxrds = obj_types.get_all_max_reco_dists();
+        auto& rds = obj_types.get_all_reco_dists();
+        auto& ras = obj_types.get_all_reco_angles();
+        const double mx[3][3] = {{0.0, 2.0, 3.0}, {2.0, 5.0, 1.0}, {3.0, 1.0, 5.0}};
+        const double rd[3][3] = {{0.0, 0.5, 0.5}, {0.5, 3.5, 0.48}, {0.5, 0.48, 2.25}};
+        for(int i=0; i<3; ++i)
+        {
+            for(int j=0; j<3; ++j)
+            {
+                mxrds[i][j] = mx[i][j];
+                rds[i][j] = rd[i][j];
+                if(i+j>0) ras[i][j] = {0.0, 0.5*MESH_PI, MESH_PI, 1.5*MESH_PI};
+            }
+        }
+    }
+    for(int use_cache=0; use_cache<2; ++use_cache)
+    {
+        sm::GeomScene scn(obj_types);
+        make_room(scn);
+        scn.set_pair_cache(use_cache);
+        const int32_t num_models = scn.get_models().size();
+        for(int oid=0; oid<num_models; ++oid)
+        {
+            if(scn.get_class(scn.get_model(oid).get_class_id()).is_fixed) continue;
+            const sm::GeomPose pose_old = scn.get_model(oid).get_pose();
+            sm::GeomPose pose = pose_old;
+            pose.pos(0,0) += 0.3;
+            pose.pos(1,0) -= 0.2;
+            pose.rot += 0.7;
+            const double delta = scn.get_cost_delta(oid, pose);
+            const double cost_old = scn.get_cost_total();
+            scn.get_model(oid).set_pose(pose);
+            const double cost_new = scn.get_cost_total();
+            scn.get_model(oid).set_pose(pose_old);
+            if(std::abs(delta-(cost_new-cost_old))>1e-9*std::max(1.0, std::abs(cost_old)))
+            {
+                std::cout<<"err: cost delta of "<<oid<<" (pair cache "<<use_cache<<")\n";
+                ++num_errs;
+            }
+        }
+        for(int mode=0; mode<2; ++mode)
+        {
+            sm::GeomAnnealer gan(scn);
+            gan.set_num_proposals(3);
+            gan.set_maxiters(30);
+            gan.set_proposal_mode(mode?sm::GeomAnnealer::ProposalMode::MultipleTry:sm::GeomAnnealer::ProposalMode::Sequential);
+            gan.solve();
+            const double cost_total = scn.get_cost_total();
+            if(std::abs(gan.get_cost_best()-cost_total)>1e-9*std::max(1.0, std::abs(cost_total)))
+            {
+                std::cout<<"err: annealer best cost (pair cache "<<use_cache<<", mode "<<mode<<")\n";
+                ++num_errs;
+            }
+        }
+    }
+
+    std::cout<<((num_errs==0)?"all checks passed":"checks failed")<<std::endl;
+    return (num_errs==0)?0:1;
+}
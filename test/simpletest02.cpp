@@ -0,0 +1,120 @@
+/*
+ *    simugeom - program package for geometry simulation 
+ *    Copyright (C) 2019, 2023 Sk. Mohammadul Haque
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */	
+
+/**
+ * @file simpletest02.cpp
+ * @author Sk. Mohammadul Haque
+ * @version 0.1.0.0
+ * @copyright
+ * Copyright (c) 2019, 2023 Sk. Mohammadul Haque.
+ * @brief This definition file contains definitions of all functions and classes of simpletest02.
+ */
+
+#include <GeomScene.h>
+#include <GeomModel.h>
+#include <GeomSceneIO.h>
+#include <GeomChecksum.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <meshlib.h>
+
+namespace sm = simugeom;
+
+static std::string get_bytes(const sm::GeomScene& scn, const int version)
+{
+    std::ostringstream os;
+    sm::GeomSceneWriter writer(scn);
+    writer.set_version(version);
+    writer.write(os);
+    return os.str();
+}
+
+static int read_bytes(sm::GeomScene& scn, const std::string& bytes)
+{
+    sm::GeomSceneReader reader(scn);
+    return reader.read(bytes.data(), bytes.size());
+}
+
+int main()
+{
+    int num_errs = 0;
+
+    // crc-32 check value
+    if(sm::get_crc32("123456789", 9)!=0xcbf43926)
+    {
+        std::cout<<"err: crc-32 check value\n";
+        ++num_errs;
+    }
+
+    sm::ObjClassSet obj_types;
+    obj_types.insert("class0", sm::ObjClass::GeomType::Cuboid, true);
+    obj_types.insert("class1", sm::ObjClass::GeomType::Ellipsoid);
+    sm::GeomScene scn(obj_types);
+    for(int k=0; k<4; ++k)
+    {
+        sm::GeomPose pose;
+        Eigen::Vector3d rad;
+        pose.pos(0,0) = 0.5*k;
+        pose.pos(1,0) = -0.25*k;
+        pose.pos(2,0) = 0.0;
+        pose.rot = k*MESH_PI/3;
+        rad(0,0) = 1.0+0.1*k;
+        rad(1,0) = 0.5;
+        rad(2,0) = 1.0;
+        sm::GeomModel gm("obj"+std::to_string(k), 0, rad, scn.get_class((k==0)?"class0":"class1"));
+        gm.set_pose(pose);
+        scn.insert(gm);
+    }
+    scn.set_seed(12345);
+
+    // v1 and v2 round trips give back the same bytes
+    const std::string bytes1 = get_bytes(scn, 1);
+    const std::string bytes2 = get_bytes(scn, 2);
+    {
+        sm::GeomScene scn2;
+        if(read_bytes(scn2, bytes2)!=0 || get_bytes(scn2, 2)!=bytes2 || get_bytes(scn2, 1)!=bytes1)
+        {
+            std::cout<<"err: v2 round trip\n";
+            ++num_errs;
+        }
+        sm::GeomScene scn1;
+        if(read_bytes(scn1, bytes1)!=0 || get_bytes(scn1, 2)!=bytes2)
+        {
+            std::cout<<"err: v1 round trip\n";
+            ++num_errs;
+        }
+    }
+
+    // a v2 file with a flipped bit anywhere after its magic is refused,
+    // without the magic it is no v2 file
+    for(std::size_t i=4; i<bytes2.size(); ++i)
+    {
+        std::string bytes = bytes2;
+        bytes[i] ^= 0x10;
+        sm::GeomScene scn2;
+        if(read_bytes(scn2, bytes)==0)
+        {
+            std::cout<<"err: corrupted byte "<<i<<" accepted\n";
+            ++num_errs;
+        }
+    }
+
+    std::cout<<((num_errs==0)?"all checks passed":"checks failed")<<std::endl;
+    return (num_errs==0)?0:1;
+}
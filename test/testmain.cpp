@@ -322,12 +322,13 @@ int main()
         {
             sm::GeomAnnealer gan(scn);
             sm::GeomRenderer grdr0(scn);
+            sm::GeomTraceTextSink trace("costs.txt");
             gan.set_renderer(grdr0);
+            gan.set_trace_sink(&trace);
             gan.set_num_proposals(15);
             gan.initialise();
             gan.set_maxiters(1200);
             gan.solve();
-            gan.export_cost_graph("costs.txt");
 
             std::cout<<scn<<std::endl;
 